@@ -0,0 +1,109 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __ABSTRACT_STATE_H__
+#define __ABSTRACT_STATE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  AbstractState.h
+///        Abstract state of a function addressed by slot.
+///
+/// Each tracked value (formal parameters, instructions, integer
+/// constants and global variables) is given a slot the first time it
+/// is inserted. Slots are consecutive integers so the abstract values,
+/// the values they belong to and the number of times they have
+/// changed are kept in flat arrays indexed by slot. Values are mapped
+/// to slots only once: code that already knows the slot (e.g.,
+/// updateState) does not need to probe any hash table.
+///
+/// The abstract values themselves are owned by the analysis (they
+/// live in its arena), not by the state.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AbstractValue.h"
+#include "llvm/Value.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+#include <cassert>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class AbstractState{
+  public:
+    /// Constructor of the class.
+    AbstractState(){}
+
+    /// Give the next slot to V and map it to A. If V already has a
+    /// slot then nothing changes. Return the slot of V.
+    inline unsigned insert(Value *V, AbstractValue *A){
+      std::pair<DenseMap<Value*,unsigned>::iterator, bool> It =
+	Slots.insert(std::make_pair(V, (unsigned) Values.size()));
+      if (It.second){
+	Vars.push_back(V);
+	Values.push_back(A);
+	NumOfChanges.push_back(0);
+      }
+      return It.first->second;
+    }
+
+    /// Return true if V has a slot and store it in Slot.
+    inline bool getSlot(Value *V, unsigned &Slot) const {
+      DenseMap<Value*,unsigned>::const_iterator It = Slots.find(V);
+      if (It == Slots.end()) return false;
+      Slot = It->second;
+      return true;
+    }
+
+    /// Return the abstract value of V or NULL if V is not tracked.
+    inline AbstractValue* lookup(Value *V) const {
+      unsigned Slot;
+      if (!getSlot(V, Slot)) return NULL;
+      return Values[Slot];
+    }
+
+    inline unsigned size() const { return Values.size(); }
+    inline Value* getValue(unsigned Slot) const {
+      assert(Slot < Vars.size());
+      return Vars[Slot];
+    }
+    inline AbstractValue* get(unsigned Slot) const {
+      assert(Slot < Values.size());
+      return Values[Slot];
+    }
+    inline void set(unsigned Slot, AbstractValue *A) {
+      assert(Slot < Values.size());
+      Values[Slot] = A;
+    }
+
+    /// Number of times the value of the slot has changed (used to
+    /// decide when to widen).
+    inline unsigned getNumOfChanges(unsigned Slot) const {
+      return NumOfChanges[Slot];
+    }
+    inline unsigned incNumOfChanges(unsigned Slot) {
+      return ++NumOfChanges[Slot];
+    }
+    inline void resetNumOfChanges(unsigned Slot) {
+      NumOfChanges[Slot] = 0;
+    }
+
+    /// Forget all the slots. The memory of the arrays is kept for the
+    /// next function.
+    inline void clear(){
+      Slots.clear();
+      Vars.clear();
+      Values.clear();
+      NumOfChanges.clear();
+    }
+
+  private:
+    DenseMap<Value*,unsigned> Slots;     //!< Map values to slots.
+    std::vector<Value*> Vars;            //!< Map slots to values.
+    std::vector<AbstractValue*> Values;  //!< Map slots to abstract values.
+    std::vector<unsigned> NumOfChanges;
+  };
+
+} // end namespace
+
+#endif
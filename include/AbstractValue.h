@@ -18,6 +18,7 @@
 /// it.
 ////////////////////////////////////////////////////////////////////////////
 
+#include "Support/Arena.h"
 #include "Support/TBool.h"
 #include "llvm/Value.h"
 #include "llvm/Constants.h"
@@ -66,6 +67,15 @@ namespace unimelb {
     /// Destructor of the class
     virtual ~AbstractValue(){}
 
+    /// Abstract values are allocated from the current Arena, if any.
+    static void* operator new(size_t Size){ return Arena::New(Size); }
+    static void  operator delete(void *Ptr, size_t Size){ 
+      Arena::Delete(Ptr, Size); 
+    }
+    /// Placement new (e.g., to store abstract values in a SmallVector).
+    static void* operator new(size_t, void *Ptr){ return Ptr; }
+    static void  operator delete(void *, void *){ }
+
     /// Return the number of times the variable has changed.
     inline unsigned  getNumOfChanges(){ return numOfChanges; }    
     /// Return a pointer to the Value associated with the abstract
@@ -117,7 +127,7 @@ namespace unimelb {
     /// this.
     virtual void join(AbstractValue * V) = 0;
     /// Special version to join multiple values if non-lattice domain.
-    virtual void GeneralizedJoin(std::vector<AbstractValue *>) = 0;
+    virtual void GeneralizedJoin(const std::vector<AbstractValue *> &) = 0;
     /// Meet two abstract values V1 and V2 and store the result in
     /// this.
     /// \todo It would be more convenient to be a friend
@@ -150,6 +160,47 @@ namespace unimelb {
     /// Execute a casting operation in the abstract domain.
     virtual AbstractValue * visitCast(Instruction &, AbstractValue *, TBool*, bool) = 0;
 
+    // In-place versions of the above transfer functions. Instead of
+    // allocating a new abstract value they store the result in the
+    // first parameter, a value of the same class that this, and
+    // return true if the result is not included in this (i.e., the
+    // abstract state would change).
+    //
+    // The default versions are built on the allocating ones so that
+    // any domain works unchanged. Range and WrappedRange override
+    // them to avoid the allocation.
+    virtual bool visitArithBinaryOpInPlace(AbstractValue *Scratch, 
+					   AbstractValue *Op1, AbstractValue *Op2,
+					   unsigned OpCode, const char *OpCodeName){
+      AbstractValue *Res = visitArithBinaryOp(Op1, Op2, OpCode, OpCodeName);
+      return copyInPlace(Scratch, Res);
+    }
+    virtual bool visitBitwiseBinaryOpInPlace(AbstractValue *Scratch,
+					     AbstractValue *Op1, AbstractValue *Op2, 
+					     const Type *Op1Ty, const Type *Op2Ty, 
+					     unsigned OpCode, const char *OpCodeName){
+      AbstractValue *Res = visitBitwiseBinaryOp(Op1, Op2, Op1Ty, Op2Ty, 
+						OpCode, OpCodeName);
+      return copyInPlace(Scratch, Res);
+    }
+    virtual bool visitCastInPlace(AbstractValue *Scratch, Instruction &I, 
+				  AbstractValue *Op, TBool *TB, bool IsSigned){
+      AbstractValue *Res = visitCast(I, Op, TB, IsSigned);
+      return copyInPlace(Scratch, Res);
+    }
+
+  private:
+    /// Copy Res into Scratch, delete Res, and return true if the
+    /// result is not included in this.
+    bool copyInPlace(AbstractValue *Scratch, AbstractValue *Res){
+      // Joining into bottom is the only copy the interface offers.
+      Scratch->makeBot();
+      Scratch->join(Res);
+      delete Res;
+      return !Scratch->lessOrEqual(this);
+    }
+
+  public:
     // Methods to evaluate a guard
     virtual bool comparisonSle(AbstractValue *) = 0;
     virtual bool comparisonSlt(AbstractValue *) = 0;
@@ -243,7 +243,10 @@ namespace unimelb {
     }
 
     /// Return true is the element is top.
-    virtual bool IsTop() const;
+    virtual bool IsTop() const{
+      if (isConstant())  return false;
+      return __isTop;
+    }
     /// Make top the element.
     virtual void makeTop();
     /// Print the abstract element.
@@ -64,6 +64,16 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "AbstractValue.h"
+#include "AbstractState.h"
+#include "Support/Arena.h"
+#include "Support/DefUseGraph.h"
+#include "Support/FunctionProfile.h"
+#include "Support/PriorityWorkList.h"
+#include "Support/SolverBudget.h"
+#include "Support/TraceLog.h"
+#include "Support/TransferCache.h"
+#include "Support/TransferCosts.h"
+#include "Support/WeakTopologicalOrder.h"
 #include "Support/Utils.h"
 #include "Support/TBool.h"
 #include "llvm/Module.h"
@@ -84,6 +94,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include <tr1/memory>
+#include <map>
 #include <set>
 #include <stack>
 
@@ -96,14 +107,10 @@ using namespace llvm;
 
 namespace unimelb {
 
-  /// Type that represents an abstract state.
-  /// The fixpoint keeps a single map from Values to AbstractValues. 
-  typedef DenseMap<Value*, AbstractValue*> AbstractStateTy;  
-  typedef SmallPtrSet<Value*,8> SmallValueSet;
-  /// Map from variable V to a set of sigma nodes S. V is a variable
-  /// that appears in a conditional branch that was used to figure out
-  /// the value of the each sigma node in S.
-  typedef DenseMap<Value *, SmallValueSet *> SigmaUsersTy;         
+  /// Pairs (V,S) where V is a variable that appears in the
+  /// conditional branch used to figure out the value of the sigma
+  /// node S. There can be duplicates.
+  typedef std::vector<std::pair<Value *, Value *> > SigmaUsersTy;
 
   /// Class to represent a constraint.
   class BinaryConstraint{
@@ -228,14 +235,59 @@ namespace unimelb {
   // This only used for widening
   enum OrderingTy { LESS_THAN, LEX_LESS_THAN };
 
+  /// How the fixpoint is computed:
+  /// - WORKLIST: chaotic iteration driven by def-use chains. Widening
+  ///   points are chosen from the backedges of the CFG.
+  /// - WTO: recursive iteration strategy over a weak topological
+  ///   ordering of the CFG. Widening is applied only at component
+  ///   heads and inner loops stabilize before outer ones.
+  enum IterationStrategyTy { WORKLIST, WTO };
+
+  /// How the fixpoint is narrowed:
+  /// - NARROWING_PASSES: NarrowingLimit passes over all the reachable
+  ///   blocks.
+  /// - NARROWING_WORKLIST: start from the values that were widened
+  ///   and propagate the decreases along the def-use graph until
+  ///   nothing changes. The value of each instruction is narrowed at
+  ///   most NarrowingLimit times.
+  enum NarrowingStrategyTy { NARROWING_PASSES, NARROWING_WORKLIST };
+
+  /// An instruction decoded once by init() so that visitInst does not
+  /// need to inspect the IR again every time the instruction is
+  /// executed. Operands are referred to by their slot in the abstract
+  /// state.
+  struct DecodedInst{
+    /// Transfer function to apply.
+    enum KindTy { STORE, LOAD, CALL, RETURN, PHI, SELECT, TERMINATOR, 
+		  ICMP, BOOLEAN, ARITH, BITWISE, CAST, OTHER };
+    static const unsigned NO_SLOT = ~0U;
+
+    Instruction *I;
+    KindTy Kind;
+    unsigned Slot;     //!< Slot of I or NO_SLOT if not tracked.
+    /// Slot of the first two operands or NO_SLOT if they are not
+    /// tracked (e.g., undefined values).
+    unsigned Ops[2];
+    /// The source of a cast is a tracked Boolean flag. Flags are
+    /// replaced when they change so they are still looked up.
+    bool IsSrcFlag;
+  };
+
   class FixpointSSI {    
   private:
     // To compute the fixpoint. 
     void solveLocal(Function *);
     void computeFixpo();
+    // To compute the fixpoint using the recursive iteration strategy.
+    void computeFixpoWTO();
+    void solveWTOElements(unsigned, unsigned);
+    void solveWTOComponent(unsigned);
+    void visitBlock(BasicBlock *);
+    void visitBlock(unsigned);
     // To perform narrowing.
     void computeNarrowing(Function *);
     void computeOneNarrowingIter(Function *);
+    void computeNarrowingWorkList();
 
     /// Record a block as executable.
     void markBlockExecutable(BasicBlock *);
@@ -243,17 +295,31 @@ namespace unimelb {
     void markEdgeExecutable(BasicBlock *,BasicBlock *);
     /// Return true if the edge is feasible.
     bool isEdgeFeasible(BasicBlock *, BasicBlock *);
-    /// Check if abstract value changed during last execution.
-    void updateState(Instruction &, AbstractValue *);
+    /// Check if abstract value changed during last execution. If
+    /// IsChanged then the caller already knows that the new value is
+    /// not included in the old one.
+    void updateState(Instruction &, AbstractValue *, bool IsChanged=false);
+    /// The narrowing case of updateState.
+    void narrowState(Instruction &, unsigned Slot, AbstractValue *);
+    /// Remove and return the closed form of the induction variable I
+    /// (NULL if none).
+    AbstractValue* takeInductionRange(Instruction *I);
+    /// Count an acceleration (resp. widening) done by updateState.
+    void countAcceleration();
+    void countWidening();
     /// Check if Boolean flag changed during last execution.
     void updateCondFlag(Instruction &, TBool *);
 
     /// Execute an instruction I.
     void visitInst(Instruction &I);
-    /// Execute a PHI instruction I if the domain is a lattice.
+    /// Execute a decoded instruction.
+    void visitInst(const DecodedInst &D);
+    /// Execute a decoded instruction (without measuring it).
+    void dispatchInst(const DecodedInst &D);
+    /// Decode the instruction I.
+    DecodedInst decodeInst(Instruction &I);
+    /// Execute a PHI or sigma instruction I.
     void visitPHINode(PHINode &I);
-    /// Execute a PHI instruction I if the domain is not a lattice.
-    void visitPHINode(AbstractValue *&AbsVal, PHINode &I);
     /// Execute a Store instruction I.
     void visitStoreInst(StoreInst &I);
     /// Execute a Select instruction I
@@ -268,13 +334,12 @@ namespace unimelb {
     void visitTerminatorInst(TerminatorInst &I);
     /// Execute a Comparison instruction I.
     void visitComparisonInst(ICmpInst &I);
-    /// Execute a Sigma instruction
-    void visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma);
-    void visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma, 
-			BasicBlock *, BranchInst * BI);
 
     void generateFilters(Value *, Value *, BranchInst *, BasicBlock *); 
-    bool evalFilter(AbstractValue * &, Value *);
+    /// Return the filter of the sigma node LHSSigma normalized with
+    /// respect to RHSSigma. Return false if there is no filter.
+    bool getSigmaFilter(Value *LHSSigma, Value *RHSSigma, unsigned &Pred,
+			AbstractValue *&Op1, AbstractValue *&Op2);
     // void generateFilters(Value *, Value *, BranchInst *, BasicBlock *, 
     // 			 FiltersTy &);
     // bool evalFilter(AbstractValue * &, Value *, const FiltersTy );
@@ -287,6 +352,24 @@ namespace unimelb {
     void addTrackedGlobalVariablesPessimistically(Module *);
     ///  Mark the abstraction points of the function F.
     void addTrackedWideningPoints(Function *F);
+    ///  Compute the landmarks of each loop of F (see Landmarks).
+    void addLoopLandmarks(Function *F, std::map<BasicBlock*,unsigned> &);
+    ///  Sort a set of landmarks following ConstSetOrder.
+    void sortLandmarks(std::vector<int64_t> &);
+    ///  Return the landmarks used to widen the widening point I.
+    const std::vector<int64_t> & getLandmarks(Instruction *I);
+    ///  Fix the order in which the worklists process blocks and
+    ///  instructions of F.
+    void numberInstructions(Function *F);
+    ///  Generate the filters of all the sigma nodes of F.
+    void addTrackedSigmaFilters(Function *F);
+    ///  Compute the closed form of the induction variables of F.
+    void addInductionVariables(Function *F);
+    bool getInductionRange(PHINode *, APInt &, APInt &);
+    ///  Build DefUse once the instructions of F are numbered.
+    void buildDefUseGraph(Function *F);
+    ///  Decode the instructions of F into Program.
+    void decodeInstructions(Function *F);
     ///  Record the integer constants that appear in the function F.
     void addTrackedIntegerConstants(Function * F);
     void addTrackedValuesUsedSigmaNode(Value *,Value *); 
@@ -301,13 +384,27 @@ namespace unimelb {
     /// Cleanup to make sure the analysis of a function does not
     /// interfere with other functions.
     inline void Cleanup(){
+      // The abstract values and flags of the previous function all
+      // live in ValueArena so no need of deleting them one by one.
       ValueState.clear();
       TrackedCondFlags.clear();
+      ValueArena.Reset();
+      Scratch = NULL;
+      CFGOrder.clear();
       InstWorkList.clear();
       BBWorkList.clear();
+      DefUse.clear();
+      Program.clear();
+      BlockBegin.clear();
+      TrackedValuesUsedSigmaNode.clear();
+      SigmaFilters.clear();
       BBExecutable.clear();
       KnownFeasibleEdges.clear();
       WideningPoints.clear();
+      Landmarks.clear();
+      WidenedSlots.clear();
+      InductionRanges.clear();
+      VisitedSigmas.clear();
 #ifdef SKIP_TRAP_BLOCKS
       TrackedTrapBlocks.clear();
 #endif 
@@ -345,35 +442,148 @@ namespace unimelb {
     /// Create an abstract value from a value initialized to an
     /// integer constant.
     virtual AbstractValue* initAbsValIntConstant(Value *,ConstantInt *)=0;
+    /// Create an abstract value for V from the interval [Lo,Hi] of
+    /// signed integers. Return NULL if the domain cannot represent it
+    /// (the default). Only used to accelerate induction variables.
+    virtual AbstractValue* initAbsValInterval(Value *V, const APInt &Lo, 
+					      const APInt &Hi){
+      return NULL;
+    }
 
     /// To provide the analysis results to other passes.
     /// FIXME: not nice since we are returning internal information.
-    inline AbstractStateTy getValMap() const { 
+    inline const AbstractState & getValMap() const { 
       return ValueState; 
     } 
     inline bool IsReachable(BasicBlock *B) const {
       return (BBExecutable.count(B) > 0);
     }
 
+    /// Choose how the fixpoint is computed (by default, WORKLIST).
+    inline void setIterationStrategy(IterationStrategyTy S){
+      IterationStrategy = S;
+    }
+    /// Choose how the fixpoint is narrowed (by default,
+    /// NARROWING_PASSES).
+    inline void setNarrowingStrategy(NarrowingStrategyTy S){
+      NarrowingStrategy = S;
+    }
+    /// Jump to the closed form of the induction variables rather
+    /// than iterating until widening (disabled by default).
+    inline void setInductionAcceleration(bool Enable){
+      AccelerateInduction = Enable;
+    }
+    /// Widen with the constants of each loop rather than with all
+    /// the constants of the function (disabled by default).
+    inline void setLoopLandmarks(bool Enable){
+      UseLoopLandmarks = Enable;
+    }
+    /// Limit the work spent on each function (0 means no limit). See
+    /// SolverBudget.h.
+    inline void setBudget(double Seconds, uint64_t Visits, unsigned Widenings){
+      Budget.setLimits(Seconds, Visits, Widenings);
+    }
+    /// Work spent on the last function and whether it was degraded.
+    inline const SolverBudget & getBudget() const { return Budget; }
+    /// Collect a profile of each function (disabled by default).
+    inline void setProfiling(bool Enable){ Profiling = Enable; }
+    /// Profile of the last function (see FunctionProfile.h).
+    inline const FunctionProfile & getProfile() const { return Profile; }
+    /// Record the phases of each function and the size of the
+    /// worklists into B (NULL disables it). See TraceLog.h.
+    inline void setTrace(TraceLog::Buffer *B){ Trace = B; }
+    /// Measure the cost of each instruction visit (disabled by
+    /// default). Costs are accumulated across functions.
+    inline void setTransferCosts(bool Enable){ MeasureCosts = Enable; }
+    /// Cost of the instruction visits so far (see TransferCosts.h).
+    inline const TransferCosts & getTransferCosts() const { return OpCosts; }
+    /// Cache the results of up to NumEntries transfer functions (0
+    /// disables the cache). The cache is kept across functions.
+    inline void setTransferCacheSize(unsigned NumEntries){
+      Cache.resize(NumEntries);
+    }
+
+  protected:
+    /// Execute the transfer function of an arithmetic, bitwise or
+    /// casting instruction D whose current abstract value is
+    /// AbsV. Return false if D is not one of them. This version calls
+    /// the domain through the AbstractValue interface. Analyses of a
+    /// known domain override it (see FixpointSSIDomain.h).
+    virtual bool visitTransferInst(const DecodedInst &D, AbstractValue *AbsV);
+    /// The body of visitTransferInst for the domain Domain.
+    template<typename Domain>
+    bool transferInst(const DecodedInst &D, Domain *AbsV);
+    /// Same as updateState(Instruction &, AbstractValue *, bool) but
+    /// the slot of the instruction is already known. Overridden as
+    /// visitTransferInst.
+    virtual void updateState(Instruction &, unsigned Slot, AbstractValue *, 
+			     bool IsChanged);
+    /// The body of updateState for the domain Domain.
+    template<typename Domain>
+    void updateDomainState(Instruction &, unsigned Slot, Domain *NewV,
+			   bool IsChanged);
+    /// Execute a PHI or sigma instruction I whose current abstract
+    /// value is AbsV. Overridden as visitTransferInst.
+    virtual void visitPHINode(PHINode &I, AbstractValue *AbsV);
+    /// The body of visitPHINode for the domain Domain.
+    template<typename Domain>
+    void phiNode(PHINode &I, Domain *AbsV);
+    /// Execute the sigma node I storing the result in LHSSigma.
+    template<typename Domain>
+    void sigmaNode(PHINode &I, Domain *LHSSigma);
+    /// Abstract value of the K-th operand of D (NULL if not tracked).
+    inline AbstractValue* getOperand(const DecodedInst &D, unsigned K) const {
+      return (D.Ops[K] == DecodedInst::NO_SLOT ? NULL : ValueState.get(D.Ops[K]));
+    }
+
   private:
     Module * M;     //!< The module where the analysis lives.
-    AbstractStateTy ValueState; //!< Map Values to abstract values.
+    /// Iteration strategy used by solveLocal.
+    IterationStrategyTy IterationStrategy;
+    /// WTO of the current function (only if IterationStrategy is WTO).
+    WeakTopologicalOrder CFGOrder;
+    /// Incremented whenever the abstract state changes. Used by the
+    /// WTO iteration strategy to detect stabilization and by the
+    /// transfer costs to know if a visit changed something.
+    unsigned StateVersion;
+    /// Memory for all the abstract values and Boolean flags created
+    /// while analyzing the current function. 
+    Arena ValueArena;
+    /// Results of the transfer functions (disabled by default).
+    TransferCache Cache;
+    AbstractState ValueState; //!< Map Values to abstract values.
+    /// Result of the in-place transfer functions. It is only copied
+    /// if the abstract state changes.
+    AbstractValue * Scratch;
     DenseMap<Value*,TBool*> TrackedCondFlags; //!< Map Values to Boolean flags.
-    std::set<Value*> InstWorkList; //!< Worklist of instructions to process.
-    std::set<BasicBlock*>  BBWorkList; //!< Worlist of blocks to process.
+    /// Worklists of instructions and blocks to process. Both are
+    /// ordered by reverse post-order (see numberInstructions).
+    PriorityWorkList<Instruction> InstWorkList; 
+    PriorityWorkList<BasicBlock>  BBWorkList; 
+    /// Users of each instruction of the current function (numbered as
+    /// in InstWorkList), including the sigma nodes that depend on it
+    /// through a filter.
+    DefUseGraph DefUse;
+    /// The instructions of the current function decoded (indexed as
+    /// in InstWorkList). The instructions of the N-th block of
+    /// BBWorkList are [BlockBegin[N], BlockBegin[N+1]).
+    std::vector<DecodedInst> Program;
+    std::vector<unsigned> BlockBegin;
     SmallPtrSet<BasicBlock*, 16>  BBExecutable; //!< Set of executable blocks.  
     typedef std::pair<BasicBlock*,BasicBlock*> Edge; //!< CFG edge.
     std::set<Edge>  KnownFeasibleEdges;  //!< Set of executable edges.
 
     /// If a sigma node S depends on a comparison instruction that
     /// involves two variables X and Y, S will be user only of one of
-    /// them. We use this map to remember that S is user of both X and
-    /// Y.
+    /// them. We use this to remember that S is user of both X and
+    /// Y. It is only needed until DefUse is built.
     SigmaUsersTy TrackedValuesUsedSigmaNode;    
     SigmaFiltersTy SigmaFilters; 
    
-    /// Set of widening points.
-    SmallPtrSet<Instruction*,16> WideningPoints;
+    /// Set of widening points. Each one is mapped to its landmarks
+    /// in Landmarks or to NO_LANDMARKS if it uses ConstSet.
+    DenseMap<Instruction*,unsigned> WideningPoints;
+    static const unsigned NO_LANDMARKS = ~0U;
     /// If zero then widening will not be applied. Otherwise, it
     /// refers to the number of times an abstract value must change
     /// until we widen it. Once, we widen a value its counter starts
@@ -383,11 +593,53 @@ namespace unimelb {
     /// jump-set widening.
     std::vector<int64_t> ConstSet; 
     OrderingTy ConstSetOrder;
+    /// If true then each loop has its own (much smaller) set of
+    /// integer constants for jump-set widening: those in the blocks
+    /// of the loop. Otherwise all widening points use ConstSet.
+    bool UseLoopLandmarks;
+    /// Landmarks of the loops of the current function, sorted as
+    /// ConstSet.
+    std::vector<std::vector<int64_t> > Landmarks;
     /// If NarrowingLimit zero then narrowing will not be applied.
     unsigned NarrowingLimit;
     /// Internal flag for the analysis to know that it is performing
     /// narrowing.
     bool NarrowingPass;
+    NarrowingStrategyTy NarrowingStrategy;
+    /// Slots of the values widened while computing the fixpoint of
+    /// the current function (maybe repeated). Only used by
+    /// NARROWING_WORKLIST.
+    std::vector<unsigned> WidenedSlots;
+    /// Limits and work done for the current function.
+    SolverBudget Budget;
+    /// If true then the widening points that are induction variables
+    /// of the form i = phi [C, ...], [sigma(i) + K, ...], where the
+    /// sigma node is filtered by a comparison of i with a constant,
+    /// start from their closed form (see addInductionVariables).
+    bool AccelerateInduction;
+    /// Closed form of each induction variable not used yet.
+    DenseMap<Instruction*, AbstractValue*> InductionRanges;
+    /// If true then Profile is filled for each function.
+    bool Profiling;
+    FunctionProfile Profile;
+    /// Sigma nodes executed at least once (only if Profiling).
+    SmallPtrSet<PHINode*, 32> VisitedSigmas;
+    /// Timeline of the current thread (NULL if not traced).
+    TraceLog::Buffer *Trace;
+    /// If true then OpCosts records every instruction visit.
+    bool MeasureCosts;
+    TransferCosts OpCosts;
+    /// Time and state changes of the visits nested into the current
+    /// one, which are not charged to it.
+    uint64_t NestedNanos;
+    unsigned NestedChanges;
+    /// Sample the size of the worklists every TraceCounterPeriod pops.
+    static const unsigned TraceCounterPeriod = 256;
+    inline void traceWorkLists(){
+      if (Trace) 
+	Trace->counter("worklists", "instructions", InstWorkList.size(), 
+		       "blocks", BBWorkList.size());
+    }
 
     /// AA - Alias Information 
     AliasAnalysis * AA;
@@ -0,0 +1,446 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __FIXPOINT_SSI_DOMAIN_H__
+#define __FIXPOINT_SSI_DOMAIN_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  FixpointSSIDomain.h
+///        Fixpoint specialized for a known abstract domain.
+///
+/// FixpointSSI talks to the abstract domain only through the virtual
+/// AbstractValue interface so that any domain can be plugged in. For
+/// the domains of this library we know statically the class of all
+/// the abstract values of an analysis. FixpointSSIDomain<D> executes
+/// the transfer functions, PHI and sigma nodes, and the join,
+/// inclusion and widening of updateState, which is where most of the
+/// time is spent, with direct calls to D so that the compiler can
+/// inline them (e.g., isBot or IsTop). The rest of the fixpoint is
+/// shared with FixpointSSI, which remains the adapter for any other
+/// domain.
+///
+/// A domain D used here must be the only subclass of AbstractValue
+/// used by the analysis.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FixpointSSI.h"
+
+using namespace llvm;
+
+namespace unimelb {
+
+  /// Calls to the operations of the domain D used by the fixpoint
+  /// step. The calls are qualified so they do not go through the
+  /// vtable.
+  template<typename D>
+  struct DomainOps{
+    static inline D* clone(D *V){ return static_cast<D*>(V->D::clone()); }
+    static inline bool isBot(D *V){ return V->D::isBot(); }
+    static inline bool IsTop(D *V){ return V->D::IsTop(); }
+    static inline void makeBot(D *V){ V->D::makeBot(); }
+    static inline void makeTop(D *V){ V->D::makeTop(); }
+    static inline bool lessOrEqual(D *V, AbstractValue *W){
+      return V->D::lessOrEqual(W);
+    }
+    static inline void join(D *V, AbstractValue *W){ V->D::join(W); }
+    static inline void
+    GeneralizedJoin(D *V, const std::vector<AbstractValue*> &Vs){
+      V->D::GeneralizedJoin(Vs);
+    }
+    static inline void
+    widening(D *V, AbstractValue *Old, const std::vector<int64_t> &J){
+      V->D::widening(Old, J);
+    }
+    static inline void
+    filterSigma(D *V, unsigned Pred, AbstractValue *Op1, AbstractValue *Op2){
+      V->D::filterSigma(Pred, Op1, Op2);
+    }
+    static inline bool
+    visitArithBinaryOpInPlace(D *V, D *Res, AbstractValue *Op1, AbstractValue *Op2,
+			      unsigned OpCode, const char *OpCodeName){
+      return V->D::visitArithBinaryOpInPlace(Res, Op1, Op2, OpCode, OpCodeName);
+    }
+    static inline bool
+    visitBitwiseBinaryOpInPlace(D *V, D *Res, AbstractValue *Op1, AbstractValue *Op2,
+				const Type *Op1Ty, const Type *Op2Ty,
+				unsigned OpCode, const char *OpCodeName){
+      return V->D::visitBitwiseBinaryOpInPlace(Res, Op1, Op2, Op1Ty, Op2Ty,
+					       OpCode, OpCodeName);
+    }
+    static inline bool
+    visitCastInPlace(D *V, D *Res, Instruction &I, AbstractValue *Op,
+		     TBool *TB, bool IsSigned){
+      return V->D::visitCastInPlace(Res, I, Op, TB, IsSigned);
+    }
+  };
+
+  /// Unknown domain: virtual calls.
+  template<>
+  struct DomainOps<AbstractValue>{
+    typedef AbstractValue D;
+    static inline D* clone(D *V){ return V->clone(); }
+    static inline bool isBot(D *V){ return V->isBot(); }
+    static inline bool IsTop(D *V){ return V->IsTop(); }
+    static inline void makeBot(D *V){ V->makeBot(); }
+    static inline void makeTop(D *V){ V->makeTop(); }
+    static inline bool lessOrEqual(D *V, AbstractValue *W){
+      return V->lessOrEqual(W);
+    }
+    static inline void join(D *V, AbstractValue *W){ V->join(W); }
+    static inline void
+    GeneralizedJoin(D *V, const std::vector<AbstractValue*> &Vs){
+      V->GeneralizedJoin(Vs);
+    }
+    static inline void
+    widening(D *V, AbstractValue *Old, const std::vector<int64_t> &J){
+      V->widening(Old, J);
+    }
+    static inline void
+    filterSigma(D *V, unsigned Pred, AbstractValue *Op1, AbstractValue *Op2){
+      V->filterSigma(Pred, Op1, Op2);
+    }
+    static inline bool
+    visitArithBinaryOpInPlace(D *V, D *Res, AbstractValue *Op1, AbstractValue *Op2,
+			      unsigned OpCode, const char *OpCodeName){
+      return V->visitArithBinaryOpInPlace(Res, Op1, Op2, OpCode, OpCodeName);
+    }
+    static inline bool
+    visitBitwiseBinaryOpInPlace(D *V, D *Res, AbstractValue *Op1, AbstractValue *Op2,
+				const Type *Op1Ty, const Type *Op2Ty,
+				unsigned OpCode, const char *OpCodeName){
+      return V->visitBitwiseBinaryOpInPlace(Res, Op1, Op2, Op1Ty, Op2Ty,
+					    OpCode, OpCodeName);
+    }
+    static inline bool
+    visitCastInPlace(D *V, D *Res, Instruction &I, AbstractValue *Op,
+		     TBool *TB, bool IsSigned){
+      return V->visitCastInPlace(Res, I, Op, TB, IsSigned);
+    }
+  };
+
+  // Check if the new value is contained by the old value. If yes, then
+  // return and do nothing.  Otherwise, add the instruction in the
+  // worklist and apply widening if widening conditions are
+  // applicable. If we are doing a narrowing pass then widening is
+  // disabled and we don't add anything in the worklist.
+  template<typename Domain>
+  void FixpointSSI::updateDomainState(Instruction &Inst, unsigned Slot,
+				      Domain *NewV, bool IsChanged){
+    typedef DomainOps<Domain> Ops;
+
+    assert(NewV != NULL && "updateState: instruction not defined"); 
+    assert(Slot < ValueState.size() && ValueState.getValue(Slot) == &Inst);
+    if (NarrowingPass)
+      return narrowState(Inst, Slot, NewV);
+
+    ////////////////////////////////////////////////////////////////////
+    // Widening:
+    //             bottom         if n=0
+    // f^{n}_{w} = f^{n-1}_{w}    if n>0 and 
+    //                            f(f^{n-1}_{w}) \subseteq f^{n-1}_{w}
+    //             widening(f^{n-1}_{w},f(f^{n-1}_{w})) otherwise
+    // Here OldV = f^{n-1}_{w} and NewV = f(f^{n-1}_{w})
+    ////////////////////////////////////////////////////////////////////
+    assert(isa<Domain>(ValueState.get(Slot)));
+    Domain *OldV = static_cast<Domain*>(ValueState.get(Slot));
+    if (!IsChanged && Ops::lessOrEqual(NewV, OldV)){
+      // No change
+      DEBUG(dbgs() << "\nThere is no change\n");
+      // NewV is reclaimed by ValueArena when the analysis of the
+      // function finishes.
+      return;  
+    }
+    
+    // The closed form of an induction variable is tried only once. If
+    // NewV is not included in it (e.g., the loop body also assigns
+    // the variable) the guess failed and NewV goes through the
+    // normal widening path.
+    AbstractValue *IV = takeInductionRange(&Inst);
+    if (IV && !Ops::lessOrEqual(NewV, IV))
+      IV = NULL;
+
+    if (Budget.isExceeded() && WideningPoints.count(&Inst)){
+      // Out of budget: go to top so that the fixpoint is reached
+      // quickly.
+      Ops::makeTop(NewV);
+      WidenedSlots.push_back(Slot);
+    }
+    else if (IV){
+      // Jump to the closed form of the induction variable. If it is
+      // not a fixpoint the iteration just goes on from there.
+      DEBUG(dbgs() << "Accelerating " << Inst.getName() << " to ");
+      DEBUG(IV->print(dbgs()));
+      DEBUG(dbgs() << "\n");
+      countAcceleration();
+      Ops::join(NewV, IV);
+      WidenedSlots.push_back(Slot);
+    }
+    else if (Widen(&Inst,ValueState.incNumOfChanges(Slot))){
+      countWidening();
+      WidenedSlots.push_back(Slot);
+      Ops::widening(NewV, OldV, getLandmarks(&Inst));
+      // We reset the counter because we don't want to apply widening
+      // if not really needed. E.g., after a widening we can have a
+      // casting operation. If the counter is not reset then we will
+      // do widening again with potential catastrophic losses.
+      if (NewV->isLattice())
+	ValueState.resetNumOfChanges(Slot);
+    }
+    // there is change: visit uses of I.
+    delete OldV;
+    ValueState.set(Slot, NewV);
+    StateVersion++;
+    DEBUG(dbgs() << "***Added into I-WL: " << Inst << "\n");
+    InstWorkList.insert(&Inst);
+  }
+
+  /// This method covers actually two different instructions. A sigma
+  /// node is represented as a phi node but with a single incoming
+  /// block.
+  ///
+  /// If a sigma node then it attempts at improving the precision of
+  /// the value by restricting it using information from the
+  /// conditional branch of the incoming block of the sigma node.
+  ///
+  /// If a phi node then it merges the values only from feasible
+  /// predecessors.
+  template<typename Domain>
+  void FixpointSSI::phiNode(PHINode &PN, Domain *AbsVal){
+    typedef DomainOps<Domain> Ops;
+
+    unsigned Slot;
+    bool Found = ValueState.getSlot(&PN, Slot);
+    assert(Found && "updateState: instruction not in ValueState");
+    (void) Found;
+    // We do not delete New since it will be stored in a map
+    // manipulated by updateState. Instead, updateState will free the
+    // old value if it is replaced with New.
+    Domain *New = Ops::clone(AbsVal);
+
+    if (PN.getNumIncomingValues() == 1){
+      // Sigma node is represented as a phi node with exactly one
+      // incoming value.
+      DEBUG(dbgs() << "Sigma node " << PN << "\n");
+      if (Profiling && !VisitedSigmas.insert(&PN))
+	Profile.SigmaRevisits++;
+      sigmaNode(PN, New);
+    }
+    else{
+      // PHI node
+      DEBUG(dbgs() << "PHI node " << PN << "\n");
+      Ops::makeBot(New);
+      // If the abstract domain is not a lattice then we call
+      // GeneralizedJoin, a special version, for joining multiple
+      // abstract values. Non-lattice joins are not associative so
+      // different orders although sound may give different levels of
+      // precision (see our SAS'13 paper). If the abstract domain is a
+      // lattice we use the binary join repeatedly without losing
+      // precision.
+      bool IsLattice = New->isLattice();
+      bool MustBeTop = false;
+      std::vector<AbstractValue*> AbsIncVals;
+      for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
+	if (!isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()) ||
+	    PN.getIncomingValue(i)->getValueID() == Value::UndefValueVal)
+	  continue;
+	/// Merging values: since join can only lose precision we stop
+	/// if we already reach top.
+	if (IsLattice && Ops::IsTop(New)){
+	  DEBUG(dbgs() << "Skipped " << *(PN.getIncomingValue(i)) 
+		       << " because already top!\n");
+	  break;	       
+	}
+	AbstractValue * AbsIncVal = Lookup(PN.getIncomingValue(i),false);
+	DEBUG(dbgs() << "Merging " << *(PN.getIncomingValue(i)) << "\n");
+	if (!AbsIncVal){
+	  DEBUG(dbgs() << "Could not find " << *(PN.getIncomingValue(i)) 
+		       << " in the lookup table. \n");
+	  MustBeTop = true;
+	  break;
+	}
+	if (IsLattice)
+	  Ops::join(New, AbsIncVal);
+	else
+	  AbsIncVals.push_back(AbsIncVal);
+      } // end for
+      if (MustBeTop)
+	Ops::makeTop(New);
+      else if (!IsLattice)
+	Ops::GeneralizedJoin(New, AbsIncVals);
+    }
+
+    updateDomainState(PN, Slot, New, false);
+    DEBUG(dbgs() << "\t[RESULT] ");
+    DEBUG(New->print(dbgs()));
+    DEBUG(dbgs() << "\n");        
+  }
+
+  // Execute a sigma node in two steps. The execution consists of
+  // assigning the incoming value to LHSSigma. Additionally, knowledge
+  // from the branch of the incoming block is used to improve
+  // LHSSigma: the filter generated by addTrackedSigmaFilters for the
+  // branch condition is executed.
+  template<typename Domain>
+  void FixpointSSI::sigmaNode(PHINode &PN, Domain *LHSSigma){
+    typedef DomainOps<Domain> Ops;
+
+    BranchInst *BI = 
+      dyn_cast_or_null<BranchInst>(PN.getIncomingBlock(0)->getTerminator());
+    if (!BI) 
+      return;
+
+    Value *RHSSigma = PN.getIncomingValue(0);
+    unsigned Pred;
+    AbstractValue *Op1, *Op2;
+    if (BI->isConditional() && 
+	getSigmaFilter(LHSSigma->getValue(), RHSSigma, Pred, Op1, Op2)){
+      // After normalization we know that Op1 is the default value for
+      // LHS which we hope to refine by using Op2. Here we cannot
+      // filter if Op2 is top or bottom.
+      assert(isa<Domain>(Op2));
+      Domain *Op2D = static_cast<Domain*>(Op2);
+      if (!Ops::IsTop(Op2D) && !Ops::isBot(Op2D)){
+	DEBUG(LHSSigma->print(dbgs()); dbgs() << "\n");
+	Ops::filterSigma(LHSSigma, Pred, Op1, Op2);
+	DEBUG(LHSSigma->print(dbgs()); dbgs() << "\n");
+	return;
+      }
+    }
+
+    // Assign RHSSigma to LHSSigma. In programs like 176.gcc we have
+    // things like:
+    //  %.01.i = phi i32 [ ptrtoint (double* getelementptr inbounds 
+    //                     (%struct.fooalign* null, i32 0, i32 1) to i32), 
+    //                     %bb3.i ]
+    // Thus, RHSSigma may not be found.
+    Ops::makeBot(LHSSigma);
+    if (AbstractValue *AbsVal = Lookup(RHSSigma,false))
+      Ops::join(LHSSigma, AbsVal);
+    else
+      Ops::makeTop(LHSSigma);
+  }
+
+  /// The transfer functions are executed in place on Scratch so that
+  /// we only allocate memory if the abstract state changes.
+  template<typename Domain>
+  bool FixpointSSI::transferInst(const DecodedInst &D, Domain *AbsV){
+    typedef DomainOps<Domain> Ops;
+    Instruction &I = *D.I;
+
+    if (!Scratch)
+      Scratch = Ops::clone(AbsV);
+    assert(isa<Domain>(Scratch));
+    Domain *S = static_cast<Domain*>(Scratch);
+    // If false then the result is top.
+    bool IsDefined = false;
+    bool IsChanged = true;
+
+    switch (D.Kind){
+    case DecodedInst::ARITH:
+      {
+	DEBUG(dbgs() << "Arithmetic instruction: " << I << "\n");
+	///
+	// We can have instructions like
+	// %tmp65 = sub i32 %tmp64, ptrtoint ([6 x %struct._IO_FILE*]* @xgets.F to i32)
+	// Therefore, we need to check if the operands are in
+	// ValueState. If not, just top.
+	////
+	AbstractValue * Op1 = getOperand(D, 0);
+	AbstractValue * Op2 = getOperand(D, 1);
+	if (Op1 && Op2){
+	  IsChanged = Ops::visitArithBinaryOpInPlace(AbsV, S, Op1, Op2,
+						     I.getOpcode(),
+						     I.getOpcodeName());
+	  IsDefined = true;
+	}
+      }
+      break;
+    case DecodedInst::BITWISE:
+      {
+	DEBUG(dbgs() << "Bitwise instruction: " << I << "\n");
+	AbstractValue * Op1 = getOperand(D, 0);
+	AbstractValue * Op2 = getOperand(D, 1);
+	if (Op1 && Op2){
+	  IsChanged = Ops::visitBitwiseBinaryOpInPlace(AbsV, S, Op1, Op2,
+						       I.getOperand(0)->getType(),
+						       I.getOperand(1)->getType(),
+						       I.getOpcode(),
+						       I.getOpcodeName());
+	  IsDefined = true;
+	}
+      }
+      break;
+    case DecodedInst::CAST:
+      {
+	DEBUG(dbgs() << "Casting instruction: " << I << "\n");
+	// Tricky step: the source of the casting instruction may be
+	// a Boolean Flag.  If yes, we need to convert the Boolean
+	// flag into an abstract value. This must be done by the
+	// class that implements AbstractValue.
+	TBool * SrcFlag  = NULL;
+	AbstractValue *SrcAbsV = NULL;
+	if (D.IsSrcFlag)
+	  SrcFlag = TrackedCondFlags.lookup(I.getOperand(0));
+	else
+	  SrcAbsV = getOperand(D, 0);
+
+	if (SrcFlag || SrcAbsV){
+	  IsChanged = Ops::visitCastInPlace(AbsV, S, I, SrcAbsV, SrcFlag,
+					    IsAllSigned);
+	  IsDefined = true;
+	}
+      }
+      break;
+    default:
+      return false;
+    } // end switch
+
+    Domain *New = NULL;
+    if (IsDefined){
+      // Same test than updateState but without allocating anything.
+      if (!IsChanged && !NarrowingPass){
+	DEBUG(dbgs() << "\nThere is no change\n");
+	return true;
+      }
+      New = Ops::clone(S);
+    }
+    else{
+      New = Ops::clone(AbsV);
+      Ops::makeTop(New);
+    }
+    // We do not delete New since it will be stored in a map
+    // manipulated by updateState. Instead, updateState will free
+    // the old value if it is replaced with New.
+    updateDomainState(I, D.Slot, New, IsDefined && IsChanged);
+    return true;
+  }
+
+  template<typename D>
+  class FixpointSSIDomain: public FixpointSSI {
+  public:
+    /// Constructors of the class
+    FixpointSSIDomain(Module *M, unsigned WL, unsigned NL, AliasAnalysis *AA,
+		      OrderingTy Ord):
+      FixpointSSI(M, WL, NL, AA, Ord){}
+    FixpointSSIDomain(Module *M, unsigned WL, unsigned NL, AliasAnalysis *AA,
+		      bool isSigned, OrderingTy Ord):
+      FixpointSSI(M, WL, NL, AA, isSigned, Ord){}
+
+  protected:
+    virtual bool visitTransferInst(const DecodedInst &DI, AbstractValue *AbsV){
+      assert(isa<D>(AbsV));
+      return transferInst(DI, static_cast<D*>(AbsV));
+    }
+    virtual void updateState(Instruction &I, unsigned Slot, AbstractValue *NewV,
+			     bool IsChanged){
+      assert(isa<D>(NewV));
+      updateDomainState(I, Slot, static_cast<D*>(NewV), IsChanged);
+    }
+    virtual void visitPHINode(PHINode &PN, AbstractValue *AbsV){
+      assert(isa<D>(AbsV));
+      phiNode(PN, static_cast<D*>(AbsV));
+    }
+  };
+
+} // end namespace
+
+#endif
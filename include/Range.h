@@ -174,12 +174,12 @@ namespace unimelb {
     }
 
     virtual bool isBot() const;
-    virtual bool IsTop() const;
+    virtual bool IsTop() const { return BaseRange::IsTop(); }
     virtual void makeBot();
     virtual void makeTop();
     virtual bool lessOrEqual(AbstractValue * V);
     virtual void join(AbstractValue *V);
-    virtual void GeneralizedJoin(std::vector<AbstractValue *>){
+    virtual void GeneralizedJoin(const std::vector<AbstractValue *> &){
       llvm_unreachable("This is a lattice so this method should not be called");
     }
 
@@ -190,6 +190,18 @@ namespace unimelb {
     /// Return true is this is syntactically identical to V.
     virtual bool isIdentical(AbstractValue *V);
 
+    // In-place transfer functions. They are public so that
+    // FixpointSSIDomain can call them without the vtable.
+    virtual bool visitArithBinaryOpInPlace(AbstractValue *, 
+					   AbstractValue *, AbstractValue *,
+					   unsigned, const char *);
+    virtual bool 
+      visitBitwiseBinaryOpInPlace(AbstractValue *, 
+				  AbstractValue *,AbstractValue *, 
+				  const Type *,const Type *,unsigned, const char *);
+    virtual bool visitCastInPlace(AbstractValue *, Instruction &,
+				  AbstractValue *,TBool*,bool);
+
   private:	  
     // Methods to evaluate a guard.
     virtual bool comparisonSle(AbstractValue *);
@@ -210,6 +222,7 @@ namespace unimelb {
     // division, and signed/unsigned rem.
     virtual AbstractValue* visitArithBinaryOp(AbstractValue *, AbstractValue *,
 					      unsigned, const char *);
+    void ArithBinaryOp(Range *,Range *,Range *,unsigned,const char *);
     void DoArithBinaryOp(Range *,Range *,Range *,unsigned,const char *,bool &);
     void DoMultiplication(bool, Range *,Range *,Range *,bool &);
     void DoDivision(bool, Range *, Range *, Range *,bool &);
@@ -219,6 +232,8 @@ namespace unimelb {
     virtual AbstractValue* 
       visitBitwiseBinaryOp(AbstractValue *,AbstractValue *, 
 			   const Type *,const Type *,unsigned, const char *);    
+    void BitwiseBinaryOp(Range *,Range *,Range *,const Type *,const Type *,
+			 unsigned, const char *);
     void DoBitwiseBinaryOp(Range *,Range *,Range *,const Type *,const Type *,unsigned,bool &);
     void DoBitwiseShifts(Range *, Range *, Range *,unsigned, bool &);
     void DoLogicalBitwise(Range *, Range *, Range *,unsigned);
@@ -230,6 +245,7 @@ namespace unimelb {
 
     bool IsTruncateOverflow(Range *, unsigned);
     virtual AbstractValue* visitCast(Instruction &,AbstractValue *,TBool*,bool);
+    void Cast(Range *,Instruction &,AbstractValue *,TBool*,bool);
     void DoCast(Range *,Range *,const Type *,const Type *,const unsigned,bool &);
 
     bool isCrossingSouthPole(Range *);
@@ -0,0 +1,118 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __ARENA_H__
+#define __ARENA_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  Arena.h
+///        Bump allocator for the objects created during the analysis
+///        of a function.
+///
+/// The fixpoint creates and destroys a very large number of small
+/// objects (abstract values and Boolean flags) while analyzing a
+/// function. All of them die when the analysis of the function
+/// finishes. An Arena serves those objects from large slabs,
+/// recycles the ones that are deleted before that through per-size
+/// free lists, and releases everything at once with Reset().
+///
+/// Classes that want to use it (AbstractValue, TBool) define their
+/// operator new/delete in terms of Arena::New/Arena::Delete. Objects
+/// are allocated from the arena made current by an Arena::Scope and
+/// from the heap if there is none. Each object is preceded by a
+/// header that records its owner so delete always does the right
+/// thing regardless of which arena is current at that point.
+///
+/// The current arena is per thread so that several analyses can run
+/// in parallel, each one with its own arena.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Support/DataTypes.h"
+#include <cstddef>
+#include <vector>
+
+namespace unimelb {
+
+  class Arena{
+  public:
+    /// Constructor of the class
+    Arena();
+    /// Destructor of the class: release all the slabs.
+    ~Arena();
+
+    /// Release all the memory. Objects allocated from this arena must
+    /// not be used after this.
+    void Reset();
+
+    /// Total number of bytes reserved for slabs.
+    inline size_t getBytesReserved() const { return BytesReserved; }
+    /// Number of objects served by the arena since the last Reset.
+    inline unsigned getNumAllocations() const { return NumAllocations; }
+    /// Number of objects that were recycled since the last Reset.
+    inline unsigned getNumRecycled() const { return NumRecycled; }
+    /// Number of objects allocated and not deleted yet.
+    inline unsigned getNumLive() const { return NumLive; }
+    /// Peak of getNumLive since the last Reset.
+    inline unsigned getPeakLive() const { return PeakLive; }
+
+    /// Allocate Size bytes from the current arena (or from the heap).
+    static void *New(size_t Size);
+    /// Deallocate an object of Size bytes allocated by New.
+    static void Delete(void *Ptr, size_t Size);
+    /// Return the current arena.
+    static inline Arena *getCurrent() { return Current; }
+
+    /// Make an arena the current one during the lifetime of the
+    /// object and then restore the previous one.
+    class Scope{
+    public:
+      Scope(Arena &A): Prev(Arena::Current) { Arena::Current = &A; }
+      ~Scope(){ Arena::Current = Prev; }
+    private:
+      Arena *Prev;
+    };
+
+  private:
+    /// Header that precedes each object. The union makes sure that
+    /// the object that follows is suitably aligned.
+    union Header{
+      Arena   *Owner;  //!< NULL if allocated from the heap.
+      uint64_t Pad1;
+      double   Pad2;
+    };
+    struct FreeNode{
+      FreeNode *Next;
+    };
+
+    static const size_t SlabSize   = 64 * 1024;
+    static const size_t Alignment  = sizeof(Header);
+    /// Objects bigger than this are always allocated from the heap.
+    static const size_t MaxObjSize = 256;
+    static const size_t NumOfFreeLists = MaxObjSize / Alignment + 1;
+
+    std::vector<char*> Slabs;
+    char *CurPtr;  //!< Next free byte in the current slab.
+    char *End;     //!< End of the current slab.
+    FreeNode *FreeLists[NumOfFreeLists]; //!< Indexed by size/Alignment.
+    size_t   BytesReserved;
+    unsigned NumAllocations;
+    unsigned NumRecycled;
+    unsigned NumLive;
+    unsigned PeakLive;
+
+    static __thread Arena *Current;
+
+    void *Allocate(size_t Size);
+    void  Deallocate(void *Ptr, size_t Size);
+
+    static inline size_t RoundUp(size_t Size){
+      return (Size + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    // Not copyable
+    Arena(const Arena &);
+    void operator=(const Arena &);
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,85 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __DEF_USE_GRAPH_H__
+#define __DEF_USE_GRAPH_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  DefUseGraph.h
+///        Dependencies between numbered nodes in compressed sparse
+///        row (CSR) form.
+///
+/// Nodes are consecutive integers. The users of all the nodes are
+/// kept in one array and node N owns the range
+/// [Offsets[N], Offsets[N+1]). The graph is built once, node by node
+/// in increasing order, and then it is only read: walking the users
+/// of a node is a walk over contiguous memory with no pointer chasing
+/// and no hashing. The users of each node are sorted and without
+/// duplicates.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <vector>
+#include <cassert>
+
+namespace unimelb {
+
+  class DefUseGraph{
+  public:
+    typedef std::vector<unsigned>::const_iterator user_iterator;
+
+    /// Constructor of the class
+    DefUseGraph(){ Offsets.push_back(0); }
+
+    /// Start the users of the next node and return its number. The
+    /// users of the previous node cannot be added after this.
+    inline unsigned addNode(){
+      closeNode();
+      Offsets.push_back(Users.size());
+      return Offsets.size() - 2;
+    }
+    /// Add U as user of the last node.
+    inline void addUser(unsigned U){
+      assert(Offsets.size() > 1 && "addUser before addNode");
+      Users.push_back(U);
+      Offsets.back() = Users.size();
+    }
+    /// Must be called after the users of the last node are added.
+    inline void finish(){ closeNode(); }
+
+    inline unsigned getNumNodes() const { return Offsets.size() - 1; }
+    inline unsigned getNumEdges() const { return Users.size(); }
+
+    /// Users of node N. A node that was never added has no users.
+    inline user_iterator user_begin(unsigned N) const {
+      if (N >= getNumNodes()) return Users.end();
+      return Users.begin() + Offsets[N];
+    }
+    inline user_iterator user_end(unsigned N) const {
+      if (N >= getNumNodes()) return Users.end();
+      return Users.begin() + Offsets[N+1];
+    }
+
+    /// Remove all the nodes. The memory is kept for the next graph.
+    inline void clear(){
+      Offsets.clear();
+      Offsets.push_back(0);
+      Users.clear();
+    }
+
+  private:
+    std::vector<unsigned> Offsets; //!< Start of the users of each node.
+    std::vector<unsigned> Users;   //!< Users of all the nodes.
+
+    /// Sort the users of the last node and remove duplicates.
+    inline void closeNode(){
+      if (Offsets.size() < 2) return;
+      std::vector<unsigned>::iterator B = Users.begin() + Offsets[Offsets.size()-2];
+      std::sort(B, Users.end());
+      Users.erase(std::unique(B, Users.end()), Users.end());
+      Offsets.back() = Users.size();
+    }
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,63 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __FUNCTION_PROFILE_H__
+#define __FUNCTION_PROFILE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  FunctionProfile.h
+///        Where the time of the analysis of one function goes.
+///
+/// STATISTIC counters are global to the module and the budget (see
+/// SolverBudget.h) only says how much work a function took. A
+/// profile splits the wall time of a function into its phases (init,
+/// ascending fixpoint, narrowing and printing of the results) and
+/// records the counters that usually explain a slow function: how
+/// many times instructions and blocks were visited, how many
+/// widenings were applied, how many times sigma nodes were
+/// re-evaluated and the peak number of abstract values alive at the
+/// same time.
+///
+/// Profiles are only collected if requested (see
+/// FixpointSSI::setProfiling) so the analysis does not pay for the
+/// extra clock readings otherwise.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Support/SolverBudget.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Timer.h"
+
+namespace unimelb {
+
+  struct FunctionProfile{
+    // Wall time (in seconds) of each phase.
+    double InitTime;      //!< FixpointSSI::init
+    double SolveTime;     //!< FixpointSSI::solveLocal
+    double NarrowingTime; //!< FixpointSSI::computeNarrowing
+    double PrintTime;     //!< Printing of the results
+    uint64_t InstVisits;    //!< Executed instructions.
+    uint64_t BlockVisits;   //!< Executed blocks.
+    uint64_t SigmaRevisits; //!< Executions of a sigma node but the first one.
+    unsigned Widenings;     //!< Widened values.
+    /// Peak number of abstract values and Boolean flags alive.
+    unsigned PeakValues;
+    /// Limit of the budget that was exceeded (if degraded).
+    SolverBudget::ExceededTy Exceeded;
+
+    FunctionProfile(){ reset(); }
+
+    inline void reset(){
+      InitTime = SolveTime = NarrowingTime = PrintTime = 0;
+      InstVisits = BlockVisits = SigmaRevisits = 0;
+      Widenings  = PeakValues = 0;
+      Exceeded   = SolverBudget::NONE;
+    }
+
+    /// Current wall time (in seconds).
+    static inline double now(){
+      return llvm::TimeRecord::getCurrentTime(false).getWallTime();
+    }
+  };
+
+} // end namespace
+
+#endif
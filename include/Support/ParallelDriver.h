@@ -0,0 +1,231 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __PARALLEL_DRIVER_H__
+#define __PARALLEL_DRIVER_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  ParallelDriver.h
+///        Analyze the functions of a module with several threads.
+///
+/// The analysis is intraprocedural so functions can be analyzed
+/// independently. Each thread owns one analysis object (it is never
+/// shared) and repeatedly takes the next function from a shared
+/// counter. The results of each function are printed into its own
+/// buffer so they can be emitted in the original order once all
+/// threads are done: the output does not depend on the number of
+/// threads or on the scheduling.
+///
+/// If an estimate of the cost of each function is given then the
+/// functions are dispatched from the most expensive to the cheapest
+/// one, so a huge function is not started when the others are about
+/// to finish. Since every idle thread takes the next function from
+/// the same counter no thread can stay idle while there is work
+/// left, which is what work stealing would give us. The wall time
+/// spent on each function is recorded so the estimates can be
+/// checked.
+///
+/// The budget of each function (see SolverBudget.h) is also kept so
+/// the functions that exceeded it can be reported, and so is its
+/// profile (see FunctionProfile.h) together with the time spent
+/// printing its results.
+///
+/// If a trace is requested each worker records into its own track
+/// (see TraceLog.h) a span per function containing the phases of the
+/// analysis and the printing of the results.
+///
+/// If requested, the results of each function are also collected
+/// for the result store (see ResultStore.h). The analysis must then
+/// provide recordResults.
+///
+/// The calling thread also runs one of the workers. Thus, with one
+/// analysis object no thread is created at all.
+///
+/// Note that LLVM must be in multithreaded mode (see
+/// llvm_start_multithreaded) so that STATISTIC counters are updated
+/// atomically, and the objects allocated by the analyses come from
+/// thread-local arenas (see Arena.h).
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Support/FunctionProfile.h"
+#include "Support/ResultStore.h"
+#include "Support/SolverBudget.h"
+#include "Support/TraceLog.h"
+#include "llvm/Function.h"
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  template<typename Analysis>
+  class ParallelDriver{
+  public:
+    /// Constructor of the class. There is one thread per analysis in
+    /// Workers.
+    ParallelDriver(const std::vector<Analysis*> &Workers,
+		   const std::vector<Function*> &Funcs,
+		   bool PrintResults):
+      Workers(Workers), Funcs(Funcs), Outputs(Funcs.size()),
+      Times(Funcs.size(), 0.0), WorkerIds(Funcs.size(), 0),
+      Budgets(Funcs.size()), Profiles(Funcs.size()),
+      PrintResults(PrintResults), RecordResults(false), Trace(NULL), Next(0){
+      assert(!Workers.empty() && "at least one analysis is needed");
+      for (unsigned i=0; i < Funcs.size(); i++)
+	Order.push_back(i);
+    }
+
+    /// Dispatch the functions by decreasing cost. Costs[i] is the
+    /// estimated cost of the i-th function. Ties keep the original
+    /// order.
+    void setCosts(const std::vector<uint64_t> &Costs){
+      assert(Costs.size() == Funcs.size());
+      std::stable_sort(Order.begin(), Order.end(), MoreExpensive(Costs));
+    }
+
+    /// Collect the results of each function for the result store.
+    void setRecordResults(bool Record){
+      RecordResults = Record;
+      Results.resize(Record ? Funcs.size() : 0);
+    }
+
+    /// Record the timeline of each worker into Log. The i-th worker
+    /// is the thread i of the log (the calling thread is worker 0).
+    void setTrace(TraceLog *Log){
+      Trace = Log;
+    }
+
+    /// Analyze all the functions and wait until all of them are done.
+    void run(){
+      std::vector<WorkerTy> Args(Workers.size());
+      std::vector<pthread_t> Threads;
+      for (unsigned i=0; i < Workers.size(); i++){
+	Args[i].Driver = this;
+	Args[i].A      = Workers[i];
+	Args[i].Id     = i;
+	Args[i].Trace  = NULL;
+	if (Trace){
+	  // Buffers cannot be created once the threads are running.
+	  std::string Name;
+	  raw_string_ostream OS(Name);
+	  OS << (i == 0 ? "main, worker " : "worker ") << i;
+	  Trace->setThreadName(i, OS.str());
+	  Args[i].Trace = Trace->getBuffer(i);
+	}
+	Workers[i]->setTrace(Args[i].Trace);
+      }
+      // If a thread cannot be created its share of the work is just
+      // done by the others.
+      for (unsigned i=1; i < Workers.size(); i++){
+	pthread_t T;
+	if (pthread_create(&T, NULL, &ParallelDriver::runWorker, &Args[i]) == 0)
+	  Threads.push_back(T);
+      }
+      runWorker(&Args[0]);
+      for (unsigned i=0; i < Threads.size(); i++)
+	pthread_join(Threads[i], NULL);
+    }
+
+    /// Return the output produced by the analysis of the i-th function.
+    inline const std::string & getOutput(unsigned i) const {
+      return Outputs[i];
+    }
+    /// Return the wall time (in seconds) spent on the i-th function.
+    inline double getTime(unsigned i) const { return Times[i]; }
+    /// Return the worker that analyzed the i-th function.
+    inline unsigned getWorker(unsigned i) const { return WorkerIds[i]; }
+    /// Return the budget used by the i-th function.
+    inline const SolverBudget & getBudget(unsigned i) const { 
+      return Budgets[i]; 
+    }
+    /// Return the profile of the i-th function. Only the printing
+    /// time is recorded unless the analysis collects profiles.
+    inline const FunctionProfile & getProfile(unsigned i) const {
+      return Profiles[i];
+    }
+    /// Return the results of the i-th function (see setRecordResults).
+    inline const ResultStore::FunctionResults & getResults(unsigned i) const {
+      return Results[i];
+    }
+
+  private:
+    struct WorkerTy{
+      ParallelDriver *Driver;
+      Analysis *A;
+      unsigned Id;
+      TraceLog::Buffer *Trace;
+    };
+
+    struct MoreExpensive{
+      const std::vector<uint64_t> &Costs;
+      MoreExpensive(const std::vector<uint64_t> &Costs): Costs(Costs){}
+      bool operator()(unsigned i, unsigned j) const {
+	return Costs[i] > Costs[j];
+      }
+    };
+
+    const std::vector<Analysis*> &Workers;
+    const std::vector<Function*> &Funcs;
+    std::vector<unsigned> Order;      //!< Dispatch order (function indexes).
+    // One entry per function. Each one is written only by the thread
+    // that analyzes the function.
+    std::vector<std::string> Outputs;
+    std::vector<double> Times;
+    std::vector<unsigned> WorkerIds;
+    std::vector<SolverBudget> Budgets;
+    std::vector<FunctionProfile> Profiles;
+    std::vector<ResultStore::FunctionResults> Results;
+    bool PrintResults;
+    bool RecordResults;
+    TraceLog *Trace;
+    volatile sys::cas_flag Next;      //!< Next position in Order.
+
+    static void * runWorker(void *Arg){
+      WorkerTy *W = static_cast<WorkerTy*>(Arg);
+      W->Driver->analyzeFunctions(*(W->A), W->Id, W->Trace);
+      return NULL;
+    }
+
+    void analyzeFunctions(Analysis &A, unsigned Id, TraceLog::Buffer *TB){
+      while (true){
+	unsigned Pos = sys::AtomicIncrement(&Next) - 1;
+	if (Pos >= Order.size()) return;
+	unsigned i = Order[Pos];
+	Function *F = Funcs[i];
+	TraceLog::Span FS(TB, F->getName(), "function");
+	TimeRecord Start = TimeRecord::getCurrentTime(true);
+	A.init(F);
+	A.solve(F);
+	TimeRecord End = TimeRecord::getCurrentTime(false);
+	Times[i] = End.getWallTime() - Start.getWallTime();
+	WorkerIds[i] = Id;
+	Budgets[i] = A.getBudget();
+	Profiles[i] = A.getProfile();
+	if (PrintResults){
+	  TraceLog::Span PS(TB, "print");
+	  double PrintStart = FunctionProfile::now();
+	  raw_string_ostream OS(Outputs[i]);
+	  A.printResultsFunction(F, OS);
+	  OS.flush();
+	  Profiles[i].PrintTime = FunctionProfile::now() - PrintStart;
+	}
+	if (RecordResults)
+	  A.recordResults(F, Results[i]);
+      }
+    }
+
+    // Not copyable
+    ParallelDriver(const ParallelDriver &);
+    void operator=(const ParallelDriver &);
+  };
+
+} // end namespace
+
+#endif
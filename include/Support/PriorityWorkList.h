@@ -0,0 +1,119 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __PRIORITY_WORKLIST_H__
+#define __PRIORITY_WORKLIST_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  PriorityWorkList.h
+///        Worklist ordered by a precomputed index.
+///
+/// Each element is given an index the first time it is seen (or
+/// explicitly with addElement) and pop() always returns the pending
+/// element with the smallest index. If the elements are numbered
+/// following a reverse post-order of the CFG the fixpoint processes
+/// definitions before uses, and the order does not depend on where
+/// the allocator happened to put the objects.
+///
+/// Pending elements are kept in a bit vector so insert and pop do not
+/// allocate, and pop only scans forward from the lowest pending index.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
+#include <cassert>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  template<typename T>
+  class PriorityWorkList{
+  public:
+    /// Constructor of the class
+    PriorityWorkList(): Lowest(0), NumPending(0){}
+
+    /// Give to E the next index. Elements added first are popped
+    /// first.
+    inline unsigned addElement(T *E){
+      unsigned Idx = Elements.size();
+      Index.insert(std::make_pair(E, Idx));
+      Elements.push_back(E);
+      Pending.resize(Elements.size());
+      return Idx;
+    }
+
+    /// Add E to the worklist. Return false if E was already there.
+    inline bool insert(T *E){
+      unsigned Idx = getIndex(E);
+      if (Pending.test(Idx)) return false;
+      Pending.set(Idx);
+      NumPending++;
+      if (Idx < Lowest) Lowest = Idx;
+      return true;
+    }
+
+    /// Remove and return the element with the smallest index.
+    inline T* pop(){ return Elements[popIndex()]; }
+
+    /// Same as pop but return the index of the element.
+    inline unsigned popIndex(){
+      assert(!empty() && "pop from an empty worklist");
+      int Idx = Pending.test(Lowest) ? (int) Lowest : Pending.find_next(Lowest);
+      assert(Idx >= 0);
+      Pending.reset(Idx);
+      NumPending--;
+      Lowest = Idx + 1;
+      return Idx;
+    }
+
+    /// Return true if E has an index and store it in Idx.
+    inline bool lookupIndex(T *E, unsigned &Idx) const {
+      typename DenseMap<T*, unsigned>::const_iterator It = Index.find(E);
+      if (It == Index.end()) return false;
+      Idx = It->second;
+      return true;
+    }
+    inline T* getElement(unsigned Idx) const {
+      assert(Idx < Elements.size());
+      return Elements[Idx];
+    }
+    inline unsigned getNumElements() const { return Elements.size(); }
+
+    inline bool empty() const { return NumPending == 0; }
+    inline unsigned size() const { return NumPending; }
+
+    /// Remove all the pending elements but keep the indexes.
+    inline void reset(){
+      Pending.reset();
+      Lowest = 0;
+      NumPending = 0;
+    }
+
+    /// Remove all the pending elements and forget the indexes.
+    inline void clear(){
+      Elements.clear();
+      Index.clear();
+      Pending.clear();
+      Lowest = 0;
+      NumPending = 0;
+    }
+
+  private:
+    std::vector<T*> Elements;      //!< Map indexes to elements.
+    DenseMap<T*, unsigned> Index;  //!< Map elements to indexes.
+    BitVector Pending;             //!< Elements currently in the worklist.
+    unsigned Lowest;      //!< No pending element has an index smaller than this.
+    unsigned NumPending;
+
+    inline unsigned getIndex(T *E){
+      typename DenseMap<T*, unsigned>::iterator It = Index.find(E);
+      if (It != Index.end()) return It->second;
+      // Elements that were not numbered go last.
+      return addElement(E);
+    }
+  };
+
+} // end namespace
+
+#endif
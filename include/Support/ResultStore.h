@@ -0,0 +1,183 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __RESULT_STORE_H__
+#define __RESULT_STORE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  ResultStore.h
+///        Binary file with the results of the analysis.
+///
+/// For each analyzed function the file contains the interval of
+/// every named local value and whether each block is reachable. The
+/// file is written once by the analysis passes and then it is mapped
+/// into memory by the readers, so reading results needs neither
+/// parsing nor copying and several processes can share the same
+/// pages.
+///
+/// The file is made of fixed-size records followed by a pool of
+/// strings:
+/// \verbatim
+///   Header
+///   Function[NumFunctions]  sorted by name
+///   Value[NumValues]        grouped by function, sorted by name
+///   Block[NumBlocks]        grouped by function, in layout order
+///   char[StringsSize]       names (not null-terminated)
+/// \endverbatim
+/// All offsets are in bytes from the beginning of the file and all
+/// integers are in the byte order of the machine that wrote the
+/// file (the reader rejects files written with a different one).
+///
+/// This file and ResultStore.cpp do not depend on LLVM so that
+/// clients can read the results without linking it.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace unimelb {
+
+  namespace ResultStore {
+
+    const uint32_t Version = 1;
+
+    /// Flags of an interval.
+    enum { IS_BOT = 1, IS_TOP = 2, IS_SIGNED = 4, IS_WRAPPED = 8 };
+
+    struct StringRefTy{
+      uint32_t Offset;   //!< Offset in the string pool.
+      uint32_t Size;
+    };
+
+    struct Header{
+      char Magic[8];            //!< "WRAPRES\0"
+      uint32_t Version;
+      uint32_t ByteOrder;       //!< 0x01020304 as written.
+      uint32_t NumFunctions, NumValues, NumBlocks;
+      uint32_t StringsSize;
+      uint64_t FunctionsOffset, ValuesOffset, BlocksOffset, StringsOffset;
+    };
+
+    struct Function{
+      StringRefTy Name;
+      uint32_t FirstValue, NumValues;
+      uint32_t FirstBlock, NumBlocks;
+    };
+
+    /// Interval [LB,UB] of a value. Bounds are bit patterns of Width
+    /// bits. If IS_WRAPPED the interval is wrapped: it goes from LB
+    /// to UB clockwise so LB can be greater than UB. Otherwise, the
+    /// bounds are two's complement numbers if IS_SIGNED and unsigned
+    /// ones if not.
+    struct Value{
+      StringRefTy Name;
+      uint32_t Block;     //!< Index of the block of the function.
+      uint32_t Width;
+      uint32_t Flags;
+      uint32_t Padding;
+      uint64_t LB, UB;
+    };
+
+    struct Block{
+      StringRefTy Name;
+      uint32_t IsReachable;
+    };
+
+    /// Results of one function, as collected by the analysis.
+    struct FunctionResults{
+      struct ValueTy{
+	std::string Name;
+	uint32_t Block, Width, Flags;
+	uint64_t LB, UB;
+      };
+      struct BlockTy{
+	std::string Name;
+	bool IsReachable;
+      };
+      std::string Name;
+      std::vector<ValueTy> Values;
+      std::vector<BlockTy> Blocks;
+    };
+
+    /// Write the results of several functions into a file.
+    class Writer{
+    public:
+      /// Add the results of one function. Functions must have
+      /// different names.
+      void add(const FunctionResults &R){ Functions.push_back(R); }
+      /// Return false (with a message in Error) if File cannot be
+      /// written.
+      bool write(const std::string &File, std::string &Error);
+    private:
+      std::vector<FunctionResults> Functions;
+    };
+
+    /// Read-only view of a file written by Writer.
+    class Reader{
+    public:
+      Reader(): Base(NULL), Size(0), Hdr(NULL){}
+      ~Reader(){ close(); }
+
+      /// Map File into memory. Return false (with a message in
+      /// Error) if it is not a valid result store. Every offset,
+      /// index and string of the file is checked here so that the
+      /// accessors below never read outside the mapped file.
+      bool open(const std::string &File, std::string &Error);
+      void close();
+
+      inline uint32_t getNumFunctions() const { return Hdr->NumFunctions; }
+      inline const Function & getFunction(unsigned i) const {
+	return getFunctions()[i];
+      }
+      /// Return the function called Name or NULL if it is not there.
+      const Function * lookupFunction(const std::string &Name) const;
+
+      inline const Value & getValue(const Function &F, unsigned i) const {
+	return getValues()[F.FirstValue + i];
+      }
+      /// Return the value called Name of F or NULL if it is not there.
+      const Value * lookupValue(const Function &F, const std::string &Name) const;
+      inline const Block & getBlock(const Function &F, unsigned i) const {
+	return getBlocks()[F.FirstBlock + i];
+      }
+      /// Copy the results of F.
+      void getResults(const Function &F, FunctionResults &R) const;
+
+      /// Return the string S (it lives in the mapped file).
+      inline std::string getString(const StringRefTy &S) const {
+	return std::string(Base + Hdr->StringsOffset + S.Offset, S.Size);
+      }
+
+    private:
+      const char *Base;
+      size_t Size;
+      const Header *Hdr;
+
+      inline const Function * getFunctions() const {
+	return reinterpret_cast<const Function*>(Base + Hdr->FunctionsOffset);
+      }
+      inline const Value * getValues() const {
+	return reinterpret_cast<const Value*>(Base + Hdr->ValuesOffset);
+      }
+      inline const Block * getBlocks() const {
+	return reinterpret_cast<const Block*>(Base + Hdr->BlocksOffset);
+      }
+      /// Return true if [Offset,Offset+Length) is inside the file.
+      bool fits(uint64_t Offset, uint64_t Length) const;
+      /// Return true if S is inside the string pool.
+      bool checkString(const StringRefTy &S) const;
+      bool checkFunctions() const;
+      /// Compare the string S with Name as strcmp does.
+      int compare(const StringRefTy &S, const std::string &Name) const;
+
+      // Not copyable
+      Reader(const Reader &);
+      void operator=(const Reader &);
+    };
+
+  } // end namespace ResultStore
+
+} // end namespace
+
+#endif
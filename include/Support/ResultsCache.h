@@ -0,0 +1,72 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __RESULTS_CACHE_H__
+#define __RESULTS_CACHE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  ResultsCache.h
+///        Results of the analysis of functions kept across runs.
+///
+/// The analysis is intraprocedural so the result of a function only
+/// depends on its code and on the options of the analysis. Each
+/// function is given a key by hashing the textual form of its IR
+/// (after the transformations that precede the analysis) together
+/// with a string describing the domain and the options. A function
+/// whose key is in the cache does not need to be analyzed again:
+/// its printed results are just taken from the cache.
+///
+/// The cache is stored in a file. Only the entries used or added by
+/// the last run are written back so results of functions that no
+/// longer exist are eventually dropped. The key also includes
+/// AnalysisVersion so that entries computed by an older analysis are
+/// never used.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Function.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <map>
+#include <string>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class ResultsCache{
+  public:
+    /// Version of the analysis. Bump it in any change to the domains
+    /// or to the fixpoint that can change the results of a function.
+    static const unsigned AnalysisVersion = 3;
+
+    /// Constructor of the class
+    ResultsCache(){}
+
+    /// Read the entries from File. A missing file is an empty cache.
+    /// Return false (with a message in Error) if the file cannot be
+    /// parsed.
+    bool load(const std::string &File, std::string &Error);
+    /// Write the entries used or inserted since load.
+    bool save(const std::string &File, std::string &Error) const;
+
+    /// Return true if the results of the function Name with key K
+    /// are in the cache and store them in Output.
+    bool lookup(uint64_t K, StringRef Name, std::string &Output);
+    /// Remember that Output are the results of the function Name
+    /// with key K.
+    void insert(uint64_t K, StringRef Name, const std::string &Output);
+
+    /// Return the key of F analyzed with Options.
+    static uint64_t getKey(const Function *F, StringRef Options);
+
+  private:
+    struct Entry{
+      std::string Name;   //!< To detect (unlikely) collisions.
+      std::string Output;
+      bool Used;
+    };
+    std::map<uint64_t, Entry> Entries;
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,118 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __SOLVER_BUDGET_H__
+#define __SOLVER_BUDGET_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  SolverBudget.h
+///        Limits on the work spent on the fixpoint of one function.
+///
+/// The fixpoint of a function is bounded by the widening but the
+/// bound can be far too large for some (typically generated)
+/// functions. A budget limits the wall time, the number of executed
+/// instructions and the number of widenings of each function. The
+/// solver does not stop when the budget is exceeded since the
+/// intermediate results would be unsound: it keeps going but from
+/// then on every change at a widening point goes straight to top
+/// (see FixpointSSI::updateState). This finishes quickly and the
+/// results are still sound, only less precise. Such functions are
+/// said to be degraded.
+///
+/// The wall time is only checked every TimeCheckPeriod instructions
+/// so the limit can be exceeded a bit.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Timer.h"
+
+namespace unimelb {
+
+  class SolverBudget{
+  public:
+    /// Which limit was exceeded.
+    enum ExceededTy { NONE, TIME, VISITS, WIDENINGS };
+
+    /// Constructor of the class. There are no limits by default.
+    SolverBudget(): MaxSeconds(0), MaxVisits(0), MaxWidenings(0){
+      start();
+    }
+
+    /// Set the limits (0 means no limit).
+    inline void setLimits(double Seconds, uint64_t Visits, unsigned Widenings){
+      MaxSeconds   = Seconds;
+      MaxVisits    = Visits;
+      MaxWidenings = Widenings;
+    }
+    inline bool hasLimits() const {
+      return (MaxSeconds > 0 || MaxVisits > 0 || MaxWidenings > 0);
+    }
+
+    /// Start the analysis of a new function.
+    inline void start(){
+      Exceeded     = NONE;
+      NumVisits    = 0;
+      NumWidenings = 0;
+      StartTime    = llvm::TimeRecord::getCurrentTime(true).getWallTime();
+      Seconds      = 0;
+    }
+    /// Stop the clock (see getSeconds).
+    inline void stop(){
+      Seconds = getElapsed();
+    }
+
+    /// Record that an instruction was executed.
+    inline void visit(){
+      NumVisits++;
+      if (Exceeded != NONE) return;
+      if (MaxVisits > 0 && NumVisits > MaxVisits)
+	Exceeded = VISITS;
+      else if (MaxSeconds > 0 && (NumVisits % TimeCheckPeriod) == 0 &&
+	       getElapsed() > MaxSeconds)
+	Exceeded = TIME;
+    }
+    /// Record that a value was widened.
+    inline void widen(){
+      NumWidenings++;
+      if (Exceeded == NONE && MaxWidenings > 0 && NumWidenings > MaxWidenings)
+	Exceeded = WIDENINGS;
+    }
+
+    inline bool isExceeded() const { return (Exceeded != NONE); }
+    inline ExceededTy getExceeded() const { return Exceeded; }
+    inline uint64_t getNumVisits() const { return NumVisits; }
+    inline unsigned getNumWidenings() const { return NumWidenings; }
+    /// Wall time between start and stop.
+    inline double getSeconds() const { return Seconds; }
+
+    /// Name of the limit (used in reports).
+    static const char * getName(ExceededTy E){
+      switch (E){
+      case NONE:      return "none";
+      case TIME:      return "time";
+      case VISITS:    return "visits";
+      case WIDENINGS: return "widenings";
+      }
+      return "unknown";
+    }
+
+  private:
+    static const unsigned TimeCheckPeriod = 1024;
+
+    double MaxSeconds;
+    uint64_t MaxVisits;
+    unsigned MaxWidenings;
+
+    ExceededTy Exceeded;
+    uint64_t NumVisits;
+    unsigned NumWidenings;
+    double StartTime;
+    double Seconds;
+
+    inline double getElapsed() const {
+      return llvm::TimeRecord::getCurrentTime(false).getWallTime() - StartTime;
+    }
+  };
+
+} // end namespace
+
+#endif
@@ -8,6 +8,7 @@
 ///       Quick class to reason about three-valued logic
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "Support/Arena.h"
 #include "llvm/Support/raw_ostream.h"
 #include <string>
 
@@ -19,6 +20,12 @@ namespace unimelb{
     TBool(): flag(TUNDEF){}
     /// Destructor of the class
     ~TBool(){}
+
+    /// Flags are allocated from the current Arena, if any.
+    static void* operator new(size_t Size){ return Arena::New(Size); }
+    static void  operator delete(void *Ptr, size_t Size){ 
+      Arena::Delete(Ptr, Size); 
+    }
     
     /// Return true if the Boolean value is true.
     inline bool isTrue()  { return (flag == TTRUE);}
@@ -0,0 +1,132 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __TRACE_LOG_H__
+#define __TRACE_LOG_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  TraceLog.h
+///        Timeline of the analysis in the trace event format.
+///
+/// A TraceLog collects spans (a named interval of wall time) and
+/// counters (values sampled over time) and writes them as a JSON
+/// file in the trace event format of Chrome, which can be opened by
+/// chrome://tracing or by Perfetto. Unlike the aggregated counters it
+/// shows when each thing happened and on which thread.
+///
+/// Each thread writes into its own Buffer, identified by the thread
+/// id shown in the timeline, so no locking is needed. Buffers must be
+/// created (getBuffer) before the threads start and the log written
+/// after all of them are done. Spans on the same thread are nested
+/// by the viewer according to their times.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Timer.h"
+
+#include <string>
+#include <vector>
+
+namespace unimelb {
+
+  class TraceLog{
+  public:
+    /// Events of one thread.
+    class Buffer{
+    public:
+      Buffer(unsigned Tid): Tid(Tid){}
+
+      /// Record the span Name from Start to End (see TraceLog::now).
+      inline void span(llvm::StringRef Name, const char *Category,
+		       double Start, double End){
+	Event E;
+	E.Phase = 'X';
+	E.Name = Name.str();
+	E.Category = Category;
+	E.Time = Start;
+	E.Duration = End - Start;
+	E.NumArgs = 0;
+	Events.push_back(E);
+      }
+      /// Record the current value of the series Key1 and Key2 of the
+      /// counter Name.
+      inline void counter(const char *Name, const char *Key1, uint64_t Value1,
+			  const char *Key2, uint64_t Value2){
+	Event E;
+	E.Phase = 'C';
+	E.Name = Name;
+	E.Category = "counter";
+	E.Time = now();
+	E.Duration = 0;
+	E.NumArgs = 2;
+	E.Keys[0] = Key1; E.Values[0] = Value1;
+	E.Keys[1] = Key2; E.Values[1] = Value2;
+	Events.push_back(E);
+      }
+
+    private:
+      friend class TraceLog;
+      struct Event{
+	char Phase;           //!< 'X' (span) or 'C' (counter).
+	std::string Name;
+	const char *Category;
+	double Time;
+	double Duration;
+	unsigned NumArgs;
+	const char *Keys[2];
+	uint64_t Values[2];
+      };
+
+      unsigned Tid;
+      std::string ThreadName;
+      std::vector<Event> Events;
+    };
+
+    /// Record a span from the construction to the destruction of the
+    /// object. Nothing is done if the buffer is NULL. Name must
+    /// outlive the object.
+    class Span{
+    public:
+      Span(Buffer *B, llvm::StringRef Name, const char *Category = "phase"):
+	B(B), Name(Name), Category(Category), Start(B ? now() : 0){}
+      ~Span(){
+	if (B) B->span(Name, Category, Start, now());
+      }
+    private:
+      Buffer *B;
+      llvm::StringRef Name;
+      const char *Category;
+      double Start;
+    };
+
+    /// Constructor of the class. Times are relative to this point.
+    TraceLog();
+    /// Destructor of the class
+    ~TraceLog();
+
+    /// Return the buffer of the thread Tid, creating it if needed.
+    Buffer * getBuffer(unsigned Tid);
+    /// Name of the track of the thread Tid.
+    void setThreadName(unsigned Tid, llvm::StringRef Name);
+
+    /// Write all the events into File. Return false and set
+    /// ErrorInfo if it cannot be written.
+    bool write(const std::string &File, std::string &ErrorInfo) const;
+
+    /// Current wall time (in seconds).
+    static inline double now(){
+      return llvm::TimeRecord::getCurrentTime(false).getWallTime();
+    }
+
+  private:
+    double Origin;
+    std::vector<Buffer*> Buffers; //!< Indexed by thread id.
+
+    // Not copyable
+    TraceLog(const TraceLog &);
+    void operator=(const TraceLog &);
+  };
+
+} // end namespace
+
+#endif
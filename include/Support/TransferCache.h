@@ -0,0 +1,107 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __TRANSFER_CACHE_H__
+#define __TRANSFER_CACHE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  TransferCache.h
+///        Bounded cache of the results of transfer functions.
+///
+/// Real code applies the same operation to the same operands again
+/// and again (e.g., i+1 or masks with the same constants), both across
+/// fixpoint iterations and across functions. The result of a transfer
+/// function only depends on the opcode and on the operands so it can
+/// be remembered.
+///
+/// The cache is direct-mapped: each key can only live in one entry
+/// and a new key just replaces the previous one. Thus, the memory
+/// used is fixed and lookups never allocate. Only operands whose
+/// bounds fit in 64 bits are cached.
+///
+/// As with Arena, the cache used by the transfer functions is the one
+/// made current by a TransferCache::Scope. The current cache is per
+/// thread and there is none by default.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace unimelb {
+
+  class TransferCache{
+  public:
+    /// Flags of the operands and of the results.
+    enum { IS_BOT = 1, IS_TOP = 2 };
+
+    /// Operation and operands. Op2 is not used by unary operations
+    /// (casts) and then its fields must be zero.
+    struct Key{
+      unsigned Opcode;
+      unsigned Width;            //!< Width of the result.
+      unsigned Width1, Width2;   //!< Width of the operands.
+      unsigned Flags1, Flags2;   //!< IS_BOT/IS_TOP of the operands.
+      uint64_t LB1, UB1, LB2, UB2;
+      Key(): Opcode(0), Width(0), Width1(0), Width2(0), Flags1(0), Flags2(0),
+	     LB1(0), UB1(0), LB2(0), UB2(0){}
+      bool operator==(const Key &K) const{
+	return (Opcode == K.Opcode && Width == K.Width &&
+		Width1 == K.Width1 && Width2 == K.Width2 &&
+		Flags1 == K.Flags1 && Flags2 == K.Flags2 &&
+		LB1 == K.LB1 && UB1 == K.UB1 && LB2 == K.LB2 && UB2 == K.UB2);
+      }
+    };
+
+    struct Result{
+      uint64_t LB, UB;
+      unsigned Flags;     //!< IS_BOT/IS_TOP of the result.
+    };
+
+    /// Constructor of the class. The cache is disabled until it is
+    /// given some entries.
+    TransferCache(){}
+
+    /// Discard all the entries and use NumEntries (rounded
+    /// up to a power of two). Zero disables the cache.
+    void resize(unsigned NumEntries);
+    inline bool isEnabled() const { return !Entries.empty(); }
+
+    /// Return true if the result of K is in the cache and store it in
+    /// R. Lookups and hits are counted in the statistics so that the
+    /// hit rate can be checked with -stats.
+    bool lookup(const Key &K, Result &R);
+    /// Remember that R is the result of K.
+    void insert(const Key &K, const Result &R);
+
+    /// Return the current cache (NULL if none).
+    static inline TransferCache *getCurrent() { return Current; }
+
+    /// Make a cache the current one during the lifetime of the
+    /// object and then restore the previous one. A disabled cache is
+    /// never made current.
+    class Scope{
+    public:
+      Scope(TransferCache &C): Prev(TransferCache::Current) {
+	if (C.isEnabled()) TransferCache::Current = &C;
+      }
+      ~Scope(){ TransferCache::Current = Prev; }
+    private:
+      TransferCache *Prev;
+    };
+
+  private:
+    struct Entry{
+      Key K;
+      Result R;
+      bool Valid;
+    };
+
+    std::vector<Entry> Entries;
+
+    static __thread TransferCache *Current;
+
+    inline Entry & getEntry(const Key &K);
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,133 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __TRANSFER_COSTS_H__
+#define __TRANSFER_COSTS_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  TransferCosts.h
+///        Cost of the transfer functions by opcode and width.
+///
+/// For each opcode and width of the first operand (the result if
+/// it has no integer operand) the table records the number of
+/// visits, their total time, a histogram of the time of each visit
+/// and how many of them changed the abstract state. Sigma nodes and
+/// phi nodes are phi instructions but they are kept apart:
+/// filterSigma and GeneralizedJoin (which is a sequence of joins for
+/// lattices) dominate their cost.
+///
+/// The time of a visit includes the update of the state (e.g.,
+/// widening) but not the visits nested into it (e.g., the phi nodes
+/// visited when a branch makes a block executable).
+///
+/// The histogram is log-linear: exact below 16ns and then four
+/// buckets per power of two, so percentiles are within 12.5% of
+/// the real value. Recording a visit only increments a few counters;
+/// the table of each opcode and width is allocated on its first
+/// visit.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instructions.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <time.h>
+#include <vector>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class TransferCosts{
+  public:
+    /// Constructor of the class
+    TransferCosts();
+    /// Destructor of the class
+    ~TransferCosts();
+
+    /// Record a visit of I that took Nanos nanoseconds.
+    inline void record(const Instruction &I, uint64_t Nanos, bool Changed){
+      Histogram *&H = Table[getOperation(I) * NumWidths + getWidthIndex(I)];
+      if (!H) H = new Histogram();
+      H->Calls++;
+      H->TotalNanos += Nanos;
+      if (Changed) H->Changed++;
+      H->Counts[getBucket(Nanos)]++;
+    }
+
+    /// Add the visits recorded by Other.
+    void merge(const TransferCosts &Other);
+    /// Forget all the visits.
+    void clear();
+    /// Write a CSV line per opcode and width, from the most to the
+    /// least expensive in total.
+    void write(raw_ostream &Out) const;
+
+    /// Current time (in nanoseconds) of a monotonic clock. It is
+    /// much cheaper than TimeRecord.
+    static inline uint64_t now(){
+      struct timespec T;
+      clock_gettime(CLOCK_MONOTONIC, &T);
+      return (uint64_t) T.tv_sec * 1000000000ULL + T.tv_nsec;
+    }
+
+  private:
+    /// Phi nodes are recorded as one of these.
+    enum { SIGMA = Instruction::OtherOpsEnd, PHI_JOIN, NumOperations };
+    /// Widths: none (not an integer), 1, 8, 16, 32, 64 and others.
+    static const unsigned NumWidths = 7;
+    static const unsigned NumBuckets = 256;
+
+    struct Histogram{
+      uint64_t Calls;
+      uint64_t Changed;
+      uint64_t TotalNanos;
+      uint64_t Counts[NumBuckets];
+      Histogram(): Calls(0), Changed(0), TotalNanos(0){
+	for (unsigned i=0; i < NumBuckets; i++) Counts[i] = 0;
+      }
+    };
+    struct MoreExpensive;
+
+    std::vector<Histogram*> Table; //!< Indexed by operation and width.
+
+    static inline unsigned getOperation(const Instruction &I){
+      if (const PHINode *PN = dyn_cast<PHINode>(&I))
+	return (PN->getNumIncomingValues() == 1 ? SIGMA : PHI_JOIN);
+      return I.getOpcode();
+    }
+    static inline unsigned getWidthIndex(const Instruction &I){
+      const Type *Ty = I.getType();
+      if (I.getNumOperands() > 0 && I.getOperand(0)->getType()->isIntegerTy())
+	Ty = I.getOperand(0)->getType();
+      const IntegerType *ITy = dyn_cast<IntegerType>(Ty);
+      if (!ITy) return 0;
+      switch (ITy->getBitWidth()){
+      case 1:  return 1;
+      case 8:  return 2;
+      case 16: return 3;
+      case 32: return 4;
+      case 64: return 5;
+      default: return 6;
+      }
+    }
+    /// Bucket of the histogram for Nanos.
+    static inline unsigned getBucket(uint64_t Nanos){
+      if (Nanos < 16) return Nanos;
+      unsigned Octave = Log2_64(Nanos);
+      return 16 + (Octave - 4) * 4 + ((Nanos >> (Octave - 2)) & 3);
+    }
+    /// Middle of the values of the bucket B.
+    static double getBucketValue(unsigned B);
+    /// Estimate the P-th percentile of H.
+    static double getPercentile(const Histogram &H, double P);
+
+    // Not copyable
+    TransferCosts(const TransferCosts &);
+    void operator=(const TransferCosts &);
+  };
+
+} // end namespace
+
+#endif
@@ -16,6 +16,9 @@
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/InstIterator.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
 #include <set>
 
@@ -128,6 +131,23 @@ namespace unimelb {
       }
     }
 
+
+    /// Rough estimate of the cost of analyzing F. Each instruction is
+    /// visited at least once, sigma nodes are more expensive because
+    /// they evaluate filters, and each loop forces its body to be
+    /// visited several times before it stabilizes.
+    static uint64_t estimateAnalysisCost(const Function *F){
+      uint64_t NumInsts = 0, NumSigmas = 0;
+      for (const_inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I){
+	NumInsts++;
+	if (const PHINode *PN = dyn_cast<PHINode>(&*I)){
+	  if (PN->getNumIncomingValues() == 1) NumSigmas++;
+	}
+      }
+      SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
+      FindFunctionBackedges(*F, BackEdges);    
+      return (NumInsts + 2*NumSigmas) * (1 + BackEdges.size());
+    }
     
     static inline int64_t convertConstantIntToint64_t(ConstantInt *C){
       return C->getValue().getSExtValue();
@@ -168,6 +188,30 @@ namespace unimelb {
 
     ///  Record constants that appear in the program
     static void recordIntegerConstants(Function *F, std::set<int64_t> &ConstSet){
+      recordLimitConstants(ConstSet);
+      for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I)
+	recordIntegerConstants(&*I, ConstSet);
+    }
+
+    ///  Record the constants that are operands of I (and their
+    ///  neighbours).
+    static void recordIntegerConstants(Instruction *I, std::set<int64_t> &ConstSet){
+      for (User::op_iterator i = I->op_begin(), e = I->op_end(); i != e; ++i){
+	if (ConstantInt *C = dyn_cast<ConstantInt>(*i)){
+	  unsigned width;
+	  if (Utilities::getIntegerWidth(C->getType(),width)){
+	    if (width <= 64){ // Programs like susan has i288 constants!
+	      ConstSet.insert(convertConstantIntToint64_t(C)-1);
+	      ConstSet.insert(convertConstantIntToint64_t(C));
+	      ConstSet.insert(convertConstantIntToint64_t(C)+1);
+	    }
+	  }
+	}
+      } // end for
+    }
+
+    ///  Record the minimum and maximum values of common widths.
+    static void recordLimitConstants(std::set<int64_t> &ConstSet){
       //////////////////////////////////////////////////////////////////////////////
       // We also insert the maximum and minimum values for unsigned and
       // signed versions for common widths (8,16, and 32). This is
@@ -193,21 +237,6 @@ namespace unimelb {
       ConstSet.insert(smin16); ConstSet.insert(smax16); 
       ConstSet.insert(umin32); ConstSet.insert(umax32);
       ConstSet.insert(smin32); ConstSet.insert(smax32);
-      
-      for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I){
-	for (User::op_iterator i = I->op_begin(), e = I->op_end(); i != e; ++i){
-	  if (ConstantInt *C = dyn_cast<ConstantInt>(*i)){
-	    unsigned width;
-	    if (Utilities::getIntegerWidth(C->getType(),width)){
-	      if (width <= 64){ // Programs like susan has i288 constants!
-		ConstSet.insert(convertConstantIntToint64_t(C)-1);
-		ConstSet.insert(convertConstantIntToint64_t(C));
-		ConstSet.insert(convertConstantIntToint64_t(C)+1);
-	      }
-	    }
-	  }
-	} // end for
-      } // end for      
     }
 
     // For debugging
@@ -224,6 +253,21 @@ namespace unimelb {
       dbgs() << "}\n";
     }
 
+    /// Write S as a JSON string (used by the reports).
+    static void writeJSONString(raw_ostream &Out, StringRef S){
+      Out << '"';
+      for (unsigned i=0, e=S.size(); i < e; i++){
+	unsigned char C = S[i];
+	if (C == '"' || C == '\\')
+	  Out << '\\' << C;
+	else if (C < 0x20)
+	  Out << format("\\u%04x", C);
+	else
+	  Out << C;
+      }
+      Out << '"';
+    }
+
     // Lexicographical order
     static bool Lex_LessThan_Comp(int64_t x,int64_t y) {
       bool IsPositive_x, IsPositive_y;
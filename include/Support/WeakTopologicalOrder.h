@@ -0,0 +1,115 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __WEAK_TOPOLOGICAL_ORDER_H__
+#define __WEAK_TOPOLOGICAL_ORDER_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  WeakTopologicalOrder.h
+///        Weak topological ordering of the CFG of a function.
+///
+/// A weak topological ordering (WTO) is a hierarchical decomposition
+/// of a graph into nested strongly connected components. Using
+/// Bourdoncle's notation the WTO of the CFG
+///
+/// \verbatim
+///  1 -> 2 -> 3 -> 4 -> 5,   4 -> 3,   5 -> 2,   5 -> 6
+/// \endverbatim
+///
+/// is "1 (2 (3 4) 5) 6". The first element of each component is its
+/// head and every cycle of the graph goes through the head of some
+/// component. Therefore, the heads are the only points where widening
+/// is needed and the recursive iteration strategy can stabilize inner
+/// components before their enclosing ones.
+///
+/// For details, we refer to "Efficient chaotic iteration strategies
+/// with widenings" by F. Bourdoncle published in FMPA'93.
+///
+/// The WTO is stored as a flat sequence of entries. An entry that is
+/// the head of a component records how many entries the component
+/// has (head included) so that its body is just the next entries.
+///
+/// The depth-first search of the algorithm uses an explicit stack
+/// rather than recursion so that large CFGs cannot overflow the call
+/// stack.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Function.h"
+#include "llvm/BasicBlock.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CFG.h"
+#include <deque>
+#include <vector>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class WeakTopologicalOrder{
+  public:
+    struct Entry{
+      BasicBlock *Block;
+      /// Number of entries of the component if Block is a head (the
+      /// head included). Otherwise, zero.
+      unsigned Size;
+      Entry(BasicBlock *B, unsigned S): Block(B), Size(S){}
+      inline bool isHead() const { return Size > 0; }
+    };
+    typedef std::vector<Entry>::const_iterator iterator;
+
+    /// Constructor of the class.
+    WeakTopologicalOrder(): Num(0){}
+
+    /// Compute the WTO of the blocks of F reachable from the entry
+    /// block. The previous one (if any) is discarded.
+    void build(Function *F);
+    void clear();
+
+    inline unsigned size() const { return Entries.size(); }
+    inline const Entry & operator[](unsigned i) const { return Entries[i]; }
+    inline iterator begin() const { return Entries.begin(); }
+    inline iterator end() const { return Entries.end(); }
+
+    /// Return true if B is the head of some component.
+    inline bool isHead(BasicBlock *B) const { return Heads.count(B); }
+    /// Print the WTO using Bourdoncle's notation.
+    void print(raw_ostream &) const;
+
+  private:
+    typedef std::vector<Entry> Sequence;
+
+    /// A call to visit or component of Bourdoncle's algorithm. A
+    /// visit of a head becomes the component of that head once all
+    /// its successors have been visited.
+    struct Frame{
+      bool IsComponent;
+      BasicBlock *Block;
+      succ_iterator Succ, SuccEnd;
+      unsigned Head;                    //!< Value returned by visit.
+      bool Loop;
+      std::vector<Sequence> *Partition; //!< Where the result goes.
+      std::vector<Sequence> Body;       //!< Only if IsComponent.
+      Frame(BasicBlock *B, std::vector<Sequence> *P):
+	IsComponent(false), Block(B), Succ(succ_begin(B)), SuccEnd(succ_end(B)),
+	Head(0), Loop(false), Partition(P){}
+    };
+
+    Sequence Entries;
+    SmallPtrSet<BasicBlock*, 16> Heads;
+    // Only used while building the WTO. Frames is a deque so that
+    // the Body of a frame does not move while its callees fill it.
+    DenseMap<BasicBlock*, unsigned> DFN;
+    std::vector<BasicBlock*> Stack;
+    std::deque<Frame> Frames;
+    unsigned Num;
+
+    void pushVisit(BasicBlock *, std::vector<Sequence> *);
+    bool finishVisit(Frame &);
+    void finishComponent(Frame &);
+    static void append(Sequence &, const std::vector<Sequence> &);
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,110 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __WRAPPED_BOUND_H__
+#define __WRAPPED_BOUND_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file  WrappedBound.h
+///        Native representation of a bound of a wrapped interval.
+///
+/// All the integers tracked by the analysis are at most 64 bits wide
+/// (see Utilities::getIntegerWidth) so a bound fits into a single
+/// machine word. WrappedBound keeps the value masked to its width so
+/// that all arithmetic is implicitly modulo 2^w, exactly as APInt
+/// does, but without going through the generic APInt machinery.
+///
+/// The lexicographical order used by wrapped intervals (see
+/// Lex_LessThan in WrappedRange.h) coincides with the unsigned order
+/// so ult/ule are all we need.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/Support/DataTypes.h"
+#include <string>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class WrappedBound{
+  public:
+    /// Widths greater than this must use APInt.
+    static const unsigned MaxNativeWidth = 64;
+
+    /// Return true if a bound of width w can be represented natively.
+    static inline bool IsNative(unsigned w){
+      return (w > 0 && w <= MaxNativeWidth);
+    }
+
+    /// Return the mask with the w lowest bits set.
+    static inline uint64_t Mask(unsigned w){
+      return (w >= 64 ? ~((uint64_t) 0) : (((uint64_t) 1) << w) - 1);
+    }
+
+    /// Constructor of the class.
+    WrappedBound(uint64_t v, unsigned w): Val(v & Mask(w)), Width(w){}
+    /// Constructor from an APInt (its width must be at most 64).
+    explicit WrappedBound(const APInt &A):
+      Val(A.getZExtValue()), Width(A.getBitWidth()){}
+
+    inline uint64_t getValue() const { return Val; }
+    inline unsigned getBitWidth() const { return Width; }
+    inline APInt toAPInt() const { return APInt(Width, Val, false); }
+    inline std::string toString(unsigned Radix, bool Signed) const {
+      return toAPInt().toString(Radix, Signed);
+    }
+
+    static inline WrappedBound getMaxValue(unsigned w){
+      return WrappedBound(Mask(w), w);                     // 111...1
+    }
+    static inline WrappedBound getMinValue(unsigned w){
+      return WrappedBound(0, w);                           // 000...0
+    }
+    static inline WrappedBound getSignedMaxValue(unsigned w){
+      return WrappedBound(Mask(w) >> 1, w);                // 011...1
+    }
+    static inline WrappedBound getSignedMinValue(unsigned w){
+      return WrappedBound(((uint64_t) 1) << (w - 1), w);  // 100...0
+    }
+
+    /// Return true if the most significant bit is set.
+    inline bool isNegative() const { return (Val >> (Width - 1)) & 1; }
+
+    // Arithmetic modulo 2^w
+    inline WrappedBound operator+(const WrappedBound &RHS) const {
+      assert(Width == RHS.Width && "Bit widths must be the same");
+      return WrappedBound(Val + RHS.Val, Width);
+    }
+    inline WrappedBound operator-(const WrappedBound &RHS) const {
+      assert(Width == RHS.Width && "Bit widths must be the same");
+      return WrappedBound(Val - RHS.Val, Width);
+    }
+    inline WrappedBound operator+(uint64_t RHS) const {
+      return WrappedBound(Val + RHS, Width);
+    }
+    inline WrappedBound operator-(uint64_t RHS) const {
+      return WrappedBound(Val - RHS, Width);
+    }
+
+    // Comparisons
+    inline bool operator==(const WrappedBound &RHS) const {
+      assert(Width == RHS.Width && "Bit widths must be the same");
+      return Val == RHS.Val;
+    }
+    inline bool operator!=(const WrappedBound &RHS) const {
+      return !(*this == RHS);
+    }
+    inline bool operator==(uint64_t RHS) const { return Val == RHS; }
+    inline bool ult(const WrappedBound &RHS) const { return Val <  RHS.Val; }
+    inline bool ule(const WrappedBound &RHS) const { return Val <= RHS.Val; }
+    inline bool ugt(const WrappedBound &RHS) const { return Val >  RHS.Val; }
+    inline bool uge(const WrappedBound &RHS) const { return Val >= RHS.Val; }
+
+  private:
+    uint64_t Val;    //!< Always masked to Width bits.
+    unsigned Width;  //!< 1,8,16,32,64
+  };
+
+} // end namespace
+
+#endif
@@ -27,7 +27,9 @@
 
 #include "AbstractValue.h"
 #include "BaseRange.h"
+#include "Support/TransferCache.h"
 #include "Support/Utils.h"
+#include "Support/WrappedBound.h"
 #include "llvm/Function.h"
 #include "llvm/Module.h"
 #include "llvm/BasicBlock.h"
@@ -38,10 +40,9 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 
-#include <tr1/memory>
-
 /// Wrapped intervals do not make any distinction whether variables
 /// are signed or not since the analysis is signed-agnostic.
 /// Therefore, by default we assume that all operations are unsigned
@@ -53,7 +54,11 @@
 namespace unimelb {
 
   class WrappedRange;
-  typedef std::tr1::shared_ptr<WrappedRange>  WrappedRangePtr;
+  /// Segments of a wrapped interval after cutting it at the poles.
+  /// There are at most three (psplit) or four (after purging zero) so
+  /// they are stored inline.
+  typedef SmallVector<WrappedRange, 4> WrappedRangeSplit;
+  typedef SmallVector<std::pair<WrappedRange*,WrappedRange*>, 4> WrappedRangePairs;
 
   class WrappedRange: public BaseRange {
   public:      
@@ -111,6 +116,8 @@ namespace unimelb {
 
     /// Cardinality of a wrapped interval.
     static inline APInt WCard(const APInt &x, const APInt &y){
+      if (WrappedBound::IsNative(x.getBitWidth()))
+	return WCard(WrappedBound(x), WrappedBound(y)).toAPInt();
       if (x == y+1){  // ie., if [MININT,MAXINT}
 	APInt card = APInt::getMaxValue(x.getBitWidth());
 	// FIXME: getMaxValue(width) is actually 2^w - 1. 
@@ -125,6 +132,15 @@ namespace unimelb {
       }
     }
 
+    /// Cardinality of a wrapped interval using native bounds.
+    static inline WrappedBound WCard(const WrappedBound &x, 
+				     const WrappedBound &y){
+      if (x == y+1)  // ie., if [MININT,MAXINT}
+	return WrappedBound::getMaxValue(x.getBitWidth());
+      else
+	return (y - x) + 1;
+    }
+
     /// To try to have a single representation of top (e.g., [1,0],
     /// [2,1], [-1,-2], [MININT,MAXINIT], etc). This is not needed for
     /// correctness but it is vital for presentation and a fair
@@ -132,7 +148,12 @@ namespace unimelb {
     inline void normalizeTop(){
       if (isBot()) return;
 
-      if (LB == UB+1){ // implicitly using mod 2^w
+      bool IsFullCircle;
+      if (WrappedBound::IsNative(LB.getBitWidth()))
+	IsFullCircle = (WrappedBound(LB) == WrappedBound(UB)+1);
+      else
+	IsFullCircle = (LB == UB+1); // implicitly using mod 2^w
+      if (IsFullCircle){
       	DEBUG(dbgs() << "Normalizing [" << LB << "," << UB << "]"
 	             << " to top interval (" << getWidth() << " bits).\n");
       	makeTop();
@@ -162,6 +183,8 @@ namespace unimelb {
     /// Return true if | \gamma(this) | == 1 
     virtual bool isGammaSingleton() const {
       if (isBot() || IsTop()) return false;
+      if (WrappedBound::IsNative(LB.getBitWidth()))
+	return (WCard(WrappedBound(LB), WrappedBound(UB)) == 1);
       APInt lb  = getLB();
       APInt ub  = getUB();
       APInt card  = WrappedRange::WCard(lb,ub);
@@ -207,9 +230,14 @@ namespace unimelb {
       return (V->getValueID() == WrappedRangeId);
     }
 
-    virtual bool isBot() const; 
-    virtual bool IsTop() const ; 
-    virtual void makeBot();
+    // Defined here so that they can be inlined when the domain is
+    // known statically (see FixpointSSIDomain.h).
+    virtual bool isBot() const { return __isBottom; }
+    virtual bool IsTop() const { return BaseRange::IsTop(); }
+    virtual void makeBot(){
+      __isBottom=true;
+      __isTop=false;
+    }
     virtual void makeTop();
     virtual void print(raw_ostream &Out) const;
 
@@ -222,10 +250,11 @@ namespace unimelb {
     /// and north poles. The use of these guys are key for most of the
     /// arithmetic, casting and bitwise operations as well as comparison
     /// operators.
-    static std::vector<WrappedRangePtr> ssplit(const APInt&, const APInt&, unsigned);
-    static std::vector<WrappedRangePtr> nsplit(const APInt&, const APInt&, unsigned);
+    static void ssplit(const APInt&, const APInt&, unsigned, WrappedRangeSplit&);
+    static void nsplit(const APInt&, const APInt&, unsigned, WrappedRangeSplit&);
 
     bool WrappedMember(const APInt&) const;
+    bool WrappedMember(const WrappedBound&) const;
     bool WrappedlessOrEqual(AbstractValue *);
     virtual bool lessOrEqual(AbstractValue *);
     virtual void WrappedJoin(AbstractValue *);
@@ -234,7 +263,9 @@ namespace unimelb {
     /// associative. Thus, it may be more precise than apply simply
     /// join repeatedly. It can be used for operations like
     /// multiplication and phi nodes with multiple incoming values.
-    virtual void GeneralizedJoin(std::vector<AbstractValue *>);
+    virtual void GeneralizedJoin(const std::vector<AbstractValue *> &);
+    /// Same but Rs is sorted in place and no copy is made.
+    void GeneralizedJoin(SmallVectorImpl<WrappedRange *> &Rs);
     virtual void meet(AbstractValue *, AbstractValue *);
     virtual bool isEqual(AbstractValue*);
     virtual void widening(AbstractValue *, const std::vector<int64_t> &);
@@ -269,8 +300,13 @@ namespace unimelb {
     // addition, substraction, and the rest above
     virtual AbstractValue* visitArithBinaryOp(AbstractValue *, AbstractValue *,
 					      unsigned, const char *);
+    virtual bool visitArithBinaryOpInPlace(AbstractValue *, 
+					   AbstractValue *, AbstractValue *,
+					   unsigned, const char *);
     // truncation, signed/unsigned extension
     virtual AbstractValue* visitCast(Instruction &, AbstractValue *, TBool *, bool);
+    virtual bool visitCastInPlace(AbstractValue *, Instruction &, 
+				  AbstractValue *, TBool *, bool);
     // and, or, xor 
     void WrappedLogicalBitwise(WrappedRange *, 
 			       WrappedRange *, WrappedRange *,
@@ -283,6 +319,10 @@ namespace unimelb {
     virtual AbstractValue*  visitBitwiseBinaryOp(AbstractValue *, AbstractValue *, 
 						 const Type *, const Type *,
 						 unsigned, const char *);
+    virtual bool visitBitwiseBinaryOpInPlace(AbstractValue *,
+					     AbstractValue *, AbstractValue *, 
+					     const Type *, const Type *,
+					     unsigned, const char *);
 
   private: 
     bool __isBottom; //!< If true the interval is bottom.
@@ -300,6 +340,23 @@ namespace unimelb {
     /// Convenient wrapper.
     void Binary_WrappedJoin(WrappedRange *R1, WrappedRange *R2);
 
+    /// Shared by the allocating and in-place transfer functions. LHS
+    /// must be a copy of this.
+    void ArithBinaryOp(WrappedRange *, WrappedRange *, WrappedRange *,
+		       unsigned, const char *);
+    void BitwiseBinaryOp(WrappedRange *, WrappedRange *, WrappedRange *,
+			 const Type *, const Type *, unsigned, const char *);
+    void Cast(WrappedRange *, Instruction &, AbstractValue *, TBool *, bool);
+
+    /// Memoization of the transfer functions above. makeCacheKey
+    /// returns false if the operation cannot be cached (Op2 is NULL
+    /// for casts).
+    static bool makeCacheKey(TransferCache::Key &, unsigned Opcode, 
+			     const WrappedRange *Op1, const WrappedRange *Op2,
+			     unsigned Width);
+    bool lookupCache(TransferCache &, const TransferCache::Key &);
+    void insertCache(TransferCache &, const TransferCache::Key &) const;
+
   };
 
   inline raw_ostream& operator<<(raw_ostream& o, WrappedRange r) {
@@ -338,6 +395,15 @@ namespace unimelb {
     else return x.ule(y);
   }
   
+  /// Native versions: the lexicographical order is the unsigned one.
+  inline bool Lex_LessThan(const WrappedBound &x, const WrappedBound &y){
+    return x.ult(y);
+  }
+
+  inline bool Lex_LessOrEqual(const WrappedBound &x, const WrappedBound &y){
+    return x.ule(y);
+  }
+
   /// Lexicographical maximum
   inline  APInt Lex_max(const APInt &x, const APInt &y){
     return (Lex_LessOrEqual(x,y)? y : x);
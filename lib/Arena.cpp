@@ -0,0 +1,103 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  Arena.cpp
+///        Bump allocator for the objects created during the analysis
+///        of a function.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Support/Arena.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+using namespace unimelb;
+
+__thread Arena * Arena::Current = NULL;
+
+Arena::Arena():
+  CurPtr(NULL), End(NULL),
+  BytesReserved(0), NumAllocations(0), NumRecycled(0),
+  NumLive(0), PeakLive(0){
+  for (unsigned i=0; i < NumOfFreeLists; i++)
+    FreeLists[i] = NULL;
+}
+
+Arena::~Arena(){
+  Reset();
+}
+
+void Arena::Reset(){
+  for (std::vector<char*>::iterator I=Slabs.begin(), E=Slabs.end(); I!=E; ++I)
+    free(*I);
+  Slabs.clear();
+  CurPtr = End = NULL;
+  for (unsigned i=0; i < NumOfFreeLists; i++)
+    FreeLists[i] = NULL;
+  BytesReserved  = 0;
+  NumAllocations = 0;
+  NumRecycled    = 0;
+  NumLive        = 0;
+  PeakLive       = 0;
+}
+
+/// Size includes the header and it is already rounded up.
+void * Arena::Allocate(size_t Size){
+  assert(Size <= MaxObjSize);
+  NumAllocations++;
+  if (++NumLive > PeakLive) PeakLive = NumLive;
+  // Reuse a deleted object of the same size if possible.
+  FreeNode *&FL = FreeLists[Size / Alignment];
+  if (FL){
+    NumRecycled++;
+    FreeNode *N = FL;
+    FL = N->Next;
+    return N;
+  }
+  if (CurPtr + Size > End){
+    char *Slab = static_cast<char*>(malloc(SlabSize));
+    if (!Slab) throw std::bad_alloc();
+    Slabs.push_back(Slab);
+    BytesReserved += SlabSize;
+    CurPtr = Slab;
+    End    = Slab + SlabSize;
+  }
+  void *Ptr = CurPtr;
+  CurPtr += Size;
+  return Ptr;
+}
+
+/// Size includes the header and it is already rounded up.
+void Arena::Deallocate(void *Ptr, size_t Size){
+  NumLive--;
+  FreeNode *N = static_cast<FreeNode*>(Ptr);
+  FreeNode *&FL = FreeLists[Size / Alignment];
+  N->Next = FL;
+  FL = N;
+}
+
+void * Arena::New(size_t Size){
+  size_t Total = RoundUp(sizeof(Header) + Size);
+  Header *H;
+  if (Current && Total <= MaxObjSize){
+    H = static_cast<Header*>(Current->Allocate(Total));
+    H->Owner = Current;
+  }
+  else{
+    H = static_cast<Header*>(::operator new(Total));
+    H->Owner = NULL;
+  }
+  return H + 1;
+}
+
+void Arena::Delete(void *Ptr, size_t Size){
+  if (!Ptr) return;
+  Header *H = static_cast<Header*>(Ptr) - 1;
+  if (H->Owner)
+    H->Owner->Deallocate(H, RoundUp(sizeof(Header) + Size));
+  else
+    ::operator delete(H);
+}
@@ -27,7 +27,7 @@
 /// \endverbatim
 ///
 ///  Here there is type mismatch for %x. In these case, we do not call
-///  visitSigmaNode.
+///  sigmaNode.
 ///
 /// Another source of imprecision is cast instructions from floating
 /// or pointers to integers which are not tracked by the analysis.
@@ -45,7 +45,9 @@
 ///   not associative.
 /////////////////////////////////////////////////////////////////////////////////
 #include "FixpointSSI.h"
+#include "FixpointSSIDomain.h"
 #include "AbstractValue.h"
+#include "llvm/ADT/PostOrderIterator.h"
 
 using namespace llvm;
 using namespace unimelb;
@@ -58,6 +60,13 @@ STATISTIC(NumOfWideningPts   ,"Number of widening locations");
 STATISTIC(NumOfWidenings     ,"Number of widen instructions");
 STATISTIC(NumOfNarrowings    ,"Number of narrowing passes");
 STATISTIC(NumOfSkippedIns    ,"Number of skipped instructions");
+STATISTIC(NumOfWTOIters      ,"Number of iterations over WTO components");
+STATISTIC(NumOfDefUseEdges   ,"Number of edges in the def-use graphs");
+STATISTIC(NumOfDegradedFuncs ,"Number of functions that exceeded their budget");
+STATISTIC(NumOfInductionVars ,"Number of induction variables with a closed form");
+STATISTIC(NumOfAccelerations ,"Number of induction variables accelerated");
+STATISTIC(NumOfLoopLandmarks ,"Number of landmarks of all the loops");
+STATISTIC(NumOfNarrowingVisits,"Number of instructions visited by worklist narrowing");
 
 // Debugging
 void printValueInfo(Value *,Function*);
@@ -68,10 +77,21 @@ FixpointSSI::
 FixpointSSI(Module *M,  unsigned WL, unsigned NL, AliasAnalysis *AA,
 	    OrderingTy ord):
   M(M),
+  IterationStrategy(WORKLIST),
+  StateVersion(0),
+  Scratch(NULL),
   WideningLimit(WL),
   ConstSetOrder(ord),
+  UseLoopLandmarks(false),
   NarrowingLimit(NL),
   NarrowingPass(false),
+  NarrowingStrategy(NARROWING_PASSES),
+  AccelerateInduction(false),
+  Profiling(false),
+  Trace(NULL),
+  MeasureCosts(false),
+  NestedNanos(0),
+  NestedChanges(0),
   AA(AA),
   IsAllSigned(true){
   if (WideningLimit == 0)
@@ -86,10 +106,21 @@ FixpointSSI(Module *M, unsigned WL, unsigned NL,
 	    AliasAnalysis *AA, bool isSigned,
 	    OrderingTy ord):
   M(M),
+  IterationStrategy(WORKLIST),
+  StateVersion(0),
+  Scratch(NULL),
   WideningLimit(WL),
   ConstSetOrder(ord),
+  UseLoopLandmarks(false),
   NarrowingLimit(NL),
   NarrowingPass(false),
+  NarrowingStrategy(NARROWING_PASSES),
+  AccelerateInduction(false),
+  Profiling(false),
+  Trace(NULL),
+  MeasureCosts(false),
+  NestedNanos(0),
+  NestedChanges(0),
   AA(AA),
   IsAllSigned(isSigned){
   if (WideningLimit == 0)
@@ -99,10 +130,8 @@ FixpointSSI(Module *M, unsigned WL, unsigned NL,
   }
 
 FixpointSSI::~FixpointSSI(){
-  for (AbstractStateTy::iterator 
-	 I = ValueState.begin(), 
-	 E=ValueState.end(); I!=E; ++I)
-    delete I->second;
+  for (unsigned i=0, e=ValueState.size(); i < e; i++)
+    delete ValueState.get(i);
   for (DenseMap<Value*,TBool*>::iterator 
 	 I=TrackedCondFlags.begin(), 
 	 E=TrackedCondFlags.end(); I!=E; ++I)
@@ -113,7 +142,13 @@ FixpointSSI::~FixpointSSI(){
 
 void FixpointSSI::init(Function *F){
 
+  double Start = FunctionProfile::now();
+  TraceLog::Span TS(Trace, "init");
   Cleanup();
+  Profile.reset();
+  Budget.start();
+  Arena::Scope S(ValueArena);
+  TransferCache::Scope CS(Cache);
   // Pessimistic assumption about trackable global variables. In this
   // case, no bother running an expensive alias analysis.
   // addTrackedGlobalVariablesPessimistically(M);
@@ -134,7 +169,7 @@ void FixpointSSI::init(Function *F){
 	if (Utilities::getTypeAndWidth(argIt, Ty, Width)){
 	  AbstractValue *Top = initAbsValTop(argIt);
 	  Top->setBasicBlock(&F->getEntryBlock());
-	  ValueState.insert(std::make_pair(&*argIt,Top));      
+	  ValueState.insert(&*argIt,Top);
 	}
       }
     } // end for
@@ -152,7 +187,7 @@ void FixpointSSI::init(Function *F){
 	    if (Utilities::getTypeAndWidth(V, Ty, Width)){
 	      AbstractValue *Bot = initAbsValBot(V);
 	      Bot->setBasicBlock(I->getParent());
-	      ValueState.insert(std::make_pair(&*V,Bot));      	
+	      ValueState.insert(&*V,Bot);
 	    }
 	  }
 	}
@@ -164,16 +199,7 @@ void FixpointSSI::init(Function *F){
     std::set<int64_t> Set;
     Utilities::recordIntegerConstants(F,Set);
     std::copy(Set.begin(), Set.end(), std::back_inserter(ConstSet));
-    // Sort them
-    if (ConstSetOrder == LESS_THAN){
-      // Since Set is ordered already using signed < we don't need to
-      // do anything here.
-      // std::sort(ConstSet.begin(), ConstSet.end()); 
-    }
-    else if (ConstSetOrder == LEX_LESS_THAN)
-      std::sort(ConstSet.begin(), ConstSet.end(), Utilities::Lex_LessThan_Comp);
-    else 
-      llvm_unreachable("Unsupported ordering");
+    sortLandmarks(ConstSet);
     DEBUG(Utilities::printIntConstants(ConstSet));
 
     /// Create an abstract value for each integer constant in the
@@ -181,11 +207,20 @@ void FixpointSSI::init(Function *F){
     std::vector<std::pair<Value*,ConstantInt*> > NewAbsVals;
     Utilities::addTrackedIntegerConstants(F, IsAllSigned, NewAbsVals); 
     for (unsigned int i=0; i<NewAbsVals.size(); i++){
-      ValueState.insert(std::make_pair(NewAbsVals[i].first,
-				       initAbsIntConstant(NewAbsVals[i].second)));   
+      // The same constant can appear several times.
+      if (!ValueState.lookup(NewAbsVals[i].first))
+	ValueState.insert(NewAbsVals[i].first,
+			  initAbsIntConstant(NewAbsVals[i].second));   
+    }
+    if (IterationStrategy == WTO){
+      CFGOrder.build(F);
+      DEBUG(dbgs() << "WTO: ");
+      DEBUG(CFGOrder.print(dbgs()));
     }
     // Record widening points.
     addTrackedWideningPoints(F);      
+    // Fix the processing order of the worklists.
+    numberInstructions(F);
 
 #ifdef SKIP_TRAP_BLOCKS
     for (Function::iterator B = F->begin(), BE = F->end(); B != BE; ++B){
@@ -199,14 +234,48 @@ void FixpointSSI::init(Function *F){
       }
     }
 #endif     
+    addTrackedSigmaFilters(F);
+    if (AccelerateInduction)
+      addInductionVariables(F);
+    buildDefUseGraph(F);
+    decodeInstructions(F);
   }
+  if (Profiling)
+    Profile.InitTime = FunctionProfile::now() - Start;
 }
 
 
 // Iterative intraprocedural fixpoint + narrowing.
 void FixpointSSI::solve(Function *F){
-  solveLocal(F);
-  computeNarrowing(F);
+  Arena::Scope S(ValueArena);
+  TransferCache::Scope CS(Cache);
+  double Start = FunctionProfile::now();
+  {
+    TraceLog::Span TS(Trace, "fixpoint");
+    solveLocal(F);
+  }
+  double End = FunctionProfile::now();
+  // Narrowing is skipped if the budget was exceeded: the function
+  // already took too long and its results are sound anyway.
+  if (Budget.isExceeded()){
+    NumOfDegradedFuncs++;
+    DEBUG(dbgs() << "Budget exceeded (" 
+	  << SolverBudget::getName(Budget.getExceeded()) << ") for " 
+	  << F->getName() << "\n");
+  }
+  else{
+    TraceLog::Span TS(Trace, "narrowing");
+    computeNarrowing(F);
+  }
+  Budget.stop();
+  if (Profiling){
+    Profile.SolveTime     = End - Start;
+    Profile.NarrowingTime = FunctionProfile::now() - End;
+    Profile.InstVisits    = Budget.getNumVisits();
+    Profile.Widenings     = Budget.getNumWidenings();
+    Profile.PeakValues    = ValueArena.getPeakLive();
+    Profile.Exceeded      = Budget.getExceeded();
+  }
 }
 
 // Compute a intraprocedural fixpoint until no change applying the
@@ -222,88 +291,137 @@ void FixpointSSI::solveLocal(Function *F){
   // done. 
   //cleanupPreviousFunctionAnalysis(F);
   markBlockExecutable(&F->getEntryBlock());    
-  computeFixpo();
+  if (IterationStrategy == WTO)
+    computeFixpoWTO();
+  else
+    computeFixpo();
   DEBUG(dbgs () << "Fixpoint reached for " << F->getName() << ".\n");
 }
 
+/// Recursive iteration strategy (Bourdoncle'93). The elements of the
+/// WTO are visited in order and each component is iterated until its
+/// head is stable, so inner loops stabilize before outer ones. The
+/// worklists are still filled by the transfer functions but they are
+/// not needed: all the instructions of a component are revisited
+/// anyway.
+void FixpointSSI::computeFixpoWTO(){
+  solveWTOElements(0, CFGOrder.size());
+  InstWorkList.reset();
+  BBWorkList.reset();
+}
+
+/// Visit the elements of the WTO in [Begin,End).
+void FixpointSSI::solveWTOElements(unsigned Begin, unsigned End){
+  for (unsigned i = Begin; i < End; ){
+    const WeakTopologicalOrder::Entry &E = CFGOrder[i];
+    if (E.isHead()){
+      solveWTOComponent(i);
+      i += E.Size;
+    }
+    else{
+      visitBlock(E.Block);
+      i++;
+    }
+  }
+}
+
+/// Iterate the component whose head is the H-th element of the WTO
+/// until a whole pass over its body and its head changes nothing.
+/// Checking only the head is not enough: the body can already change
+/// the head (e.g., making the latch edge feasible revisits the PHI
+/// nodes of the head) and then the head itself looks stable.
+void FixpointSSI::solveWTOComponent(unsigned H){
+  const WeakTopologicalOrder::Entry &Head = CFGOrder[H];
+  visitBlock(Head.Block);
+  unsigned Version;
+  do{
+    NumOfWTOIters++;
+    Version = StateVersion;
+    solveWTOElements(H+1, H + Head.Size);
+    visitBlock(Head.Block);
+  } while (Version != StateVersion);
+}
+
+/// Visit all the instructions of BB if it is executable.
+void FixpointSSI::visitBlock(BasicBlock *BB){
+  if (!BBExecutable.count(BB)) return;
+#ifdef SKIP_TRAP_BLOCKS
+  if (TrackedTrapBlocks.count(BB)) return;
+#endif 
+  unsigned B;
+  if (BBWorkList.lookupIndex(BB, B))
+    visitBlock(B);
+  else{
+    Profile.BlockVisits++;
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+      visitInst(*I);
+  }
+}
+
+/// Visit all the instructions of the B-th block of BBWorkList.
+void FixpointSSI::visitBlock(unsigned B){
+  Profile.BlockVisits++;
+  if (B + 1 < BlockBegin.size()){
+    for (unsigned N = BlockBegin[B], E = BlockBegin[B+1]; N < E; N++)
+      visitInst(Program[N]);
+  }
+  else{
+    // The block was not decoded (e.g., the function is not tracked).
+    BasicBlock *BB = BBWorkList.getElement(B);
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+      visitInst(*I);
+  }
+}
+
 void FixpointSSI::computeFixpo(){
+  unsigned NumPops = 0;
+  traceWorkLists();
   // Process the work lists until they are empty!
   while (!BBWorkList.empty() || !InstWorkList.empty()) {
     // Process the instruction work list.
     while (!InstWorkList.empty()) {
-      std::set<Value*>::iterator It = InstWorkList.begin();
-      InstWorkList.erase(It);
-      Value *I = *It;
+      if (Trace && (++NumPops % TraceCounterPeriod) == 0) traceWorkLists();
+      unsigned N = InstWorkList.popIndex();
+      Instruction *I = InstWorkList.getElement(N);
       // "I" got into the work list because it made a transition.  See
       // if any users are both live and in need of updating.
       DEBUG(dbgs() << "\n*** Popped off I-WL: " << *I << "\n");      
       DEBUG(printUsersInst(I,BBExecutable,true));
-      for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
-           UI != E; ++UI) {
-        Instruction *U = cast<Instruction>(*UI);
-	// We check that the instruction U is defined in an executable
-	// block
-        if (BBExecutable.count(U->getParent()) && U != I) {
-	  DEBUG(dbgs() << "\n***Visiting: " << *U << " as user of " 
-		<< *I << "\n");      
-          visitInst(*U);
-	}
-      } // end for
-
-      /// We need to pay special attention to sigma nodes for two
-      /// reasons. For code like this:
-      /// \verbatim
-      /// i = phi [tmp6,...] [0,...]
-      /// ...
-      /// sigma  = phi [i,...]
-      /// tmp6 = add sigma, 1
-      /// \endverbatim
-      /// Assume that tmp6 changes from [0,0] to [1,1]. As a result,
-      /// we push tmp6 into IWorklist. Then, we analyze i and infer
-      /// than i=[0,1], and push i also in the IWorklist. If we pop
-      /// first tmp6 from IWorklist then tmp6 is again [1,1] since
-      /// sigma was not updated. This suggests that we should visit
-      /// first sigma nodes.  Another issue arises with code like this:
+      /// The users of I include the sigma nodes that are filtered by
+      /// a comparison involving I even if they do not use I
+      /// directly. For code like this:
       /// \verbatim
       /// tmp4  = icmp slt i, j
       /// ....
       /// sigma =  phi [i,..]
       /// \endverbatim
-      /// Here sigma is an user of i. However, sigma is also indirectly
-      /// an user of j. That is, if j is modified we should re-analyze
-      /// sigma. However, this dependency between j and sigma does not
-      /// appear in the def-use information.  We solve in a bit clumsy
-      /// way these two issues by tracking a map from V to set(V) that
-      /// keeps track of for a given variable V which is the set of
-      /// sigma nodes that should be re-analyzed.
-      ///
-      /// \bug: we are visiting twice the number of sigma nodes.
-      if (SmallValueSet * SigmaSet = TrackedValuesUsedSigmaNode[I]){
-	for( SmallValueSet::iterator UI = SigmaSet->begin(),
-	       UE = SigmaSet->end(); UI != UE; ++UI){
-	  Instruction * U = cast<Instruction>(*UI);
-	  if (BBExecutable.count(U->getParent())) {
-	    DEBUG(dbgs() << "\n***Forcing the visit of: " << *U 
-		  << " as user of " << *I << "\n");      
-	    visitInst(*U);
-	  }
-	} // end inner for
-      }      
+      /// sigma is an user of i but it is also indirectly an user of
+      /// j: if j is modified we must re-analyze sigma. See
+      /// buildDefUseGraph.
+      for (DefUseGraph::user_iterator UI = DefUse.user_begin(N), 
+	     E = DefUse.user_end(N); UI != E; ++UI) {
+        const DecodedInst &U = Program[*UI];
+	// We check that the instruction U is defined in an executable
+	// block
+        if (BBExecutable.count(U.I->getParent())) {
+	  DEBUG(dbgs() << "\n***Visiting: " << *U.I << " as user of " 
+		<< *I << "\n");      
+          visitInst(U);
+	}
+      } // end for
     } // end while
 
     // Process the basic block work list.
     while (!BBWorkList.empty()) {
-      std::set<BasicBlock*>::iterator BBIt = BBWorkList.begin();
-      BBWorkList.erase(BBIt);
-      BasicBlock *BB = *BBIt;
-      DEBUG(dbgs() << "\n***Popped off BBWL: " << *BB);
+      if (Trace && (++NumPops % TraceCounterPeriod) == 0) traceWorkLists();
+      unsigned B = BBWorkList.popIndex();
+      DEBUG(dbgs() << "\n***Popped off BBWL: " << *BBWorkList.getElement(B));
       // Notify all instructions in this basic block that they are newly
       // executable.
-      for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I){
-        visitInst(*I);
-      }
+      visitBlock(B);
     } // end while
   } // end outer while
+  traceWorkLists();
 }
 
 /// Iterate over all instructions in the function and apply the
@@ -319,12 +437,9 @@ void FixpointSSI::computeOneNarrowingIter(Function *F){
        DFI != DFE; ++DFI) {  
 
     BasicBlock * BB = *DFI;
-    if (BBExecutable.count(BB)){
-      for (BasicBlock::iterator I = BB->begin(), E = BB->end(); 
-	   I != E; ++I){
-	  visitInst(*I);
-      }
-    }
+    unsigned B;
+    if (BBExecutable.count(BB) && BBWorkList.lookupIndex(BB, B))
+      visitBlock(B);
   }
 }
 
@@ -334,6 +449,11 @@ void FixpointSSI::computeNarrowing(Function *EntryF){
 
   if (NarrowingLimit == 0) return;
 
+  if (NarrowingStrategy == NARROWING_WORKLIST){
+    computeNarrowingWorkList();
+    return;
+  }
+
   unsigned N = NarrowingLimit;
   NarrowingPass=true;
 
@@ -354,6 +474,66 @@ void FixpointSSI::computeNarrowing(Function *EntryF){
   DEBUG(dbgs () << "Narrowing finished.\n");
 }
 
+// Narrowing driven by the def-use graph. The result of the fixpoint
+// is a post-fixpoint and only the widened values can be above the
+// result of their transfer functions, so narrowing starts by
+// re-executing the widened instructions and then, as computeFixpo
+// does, it only visits the users of the values that changed. Every
+// value of the sequence is still an over-approximation so we can stop
+// at any point: when nothing changes, when a value has been narrowed
+// NarrowingLimit times (see updateState) or after NarrowingLimit
+// visits per instruction in total.
+void FixpointSSI::computeNarrowingWorkList(){
+  // Nothing was widened: the fixpoint cannot be improved.
+  if (WidenedSlots.empty()) return;
+
+  std::sort(WidenedSlots.begin(), WidenedSlots.end());
+  WidenedSlots.erase(std::unique(WidenedSlots.begin(), WidenedSlots.end()),
+		     WidenedSlots.end());
+  DEBUG(dbgs () << "\nStarting narrowing from " << WidenedSlots.size() 
+	<< " widened values ... \n");
+  NumOfNarrowings++;    
+  NarrowingPass=true;
+  assert(InstWorkList.empty() && "The worklist should be empty");
+
+  // From now on the counters of changes are the number of times each
+  // value has been narrowed.
+  for (unsigned S=0, E=ValueState.size(); S < E; S++)
+    ValueState.resetNumOfChanges(S);
+
+  for (unsigned i=0, e=WidenedSlots.size(); i < e; i++){
+    Instruction *I = cast<Instruction>(ValueState.getValue(WidenedSlots[i]));
+    if (BBExecutable.count(I->getParent())){
+      NumOfNarrowingVisits++;
+      visitInst(*I);
+    }
+  }
+
+  unsigned VisitsLeft = NarrowingLimit * Program.size();
+  unsigned NumPops = 0;
+  traceWorkLists();
+  while (!InstWorkList.empty() && VisitsLeft > 0) {
+    if (Trace && (++NumPops % TraceCounterPeriod) == 0) traceWorkLists();
+    unsigned N = InstWorkList.popIndex();
+    for (DefUseGraph::user_iterator UI = DefUse.user_begin(N), 
+	   E = DefUse.user_end(N); UI != E && VisitsLeft > 0; ++UI) {
+      const DecodedInst &U = Program[*UI];
+      if (BBExecutable.count(U.I->getParent())) {
+	VisitsLeft--;
+	NumOfNarrowingVisits++;
+	visitInst(U);
+      }
+    }
+  }
+  // The blocks cannot become reachable here and the instructions
+  // left (if VisitsLeft ran out) are not needed.
+  InstWorkList.reset();
+  BBWorkList.reset();
+  traceWorkLists();
+  NarrowingPass=false;
+  DEBUG(dbgs () << "Narrowing finished.\n");
+}
+
 bool FixpointSSI::
 isEdgeFeasible(BasicBlock *From, BasicBlock *To){
   std::set<Edge>::iterator 
@@ -366,79 +546,80 @@ isEdgeFeasible(BasicBlock *From, BasicBlock *To){
   }
 }
 
-// Check if the new value is contained by the old value. If yes, then
-// return and do nothing.  Otherwise, add the instruction in the
-// worklist and apply widening if widening conditions are
-// applicable. If we are doing a narrowing pass then widening is
-// disabled and we don't add anything in the worklist.
-void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV) {
-
-  assert(NewV != NULL && "updateState: instruction not defined"); 
-  AbstractStateTy::iterator I = ValueState.find(&Inst);
-  AbstractValue* OldV  = I->second;
-
-  // DEBUG(dbgs() << "Old value: " );
-  // DEBUG(OldV->print(dbgs()));
-  // DEBUG(dbgs() << "\n" );
-  // DEBUG(dbgs() << "New value: " );
-  // DEBUG(NewV->print(dbgs()));
-  // DEBUG(dbgs() << "\n" );
+/// Find the slot of Inst and update it (see updateDomainState).
+void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV, 
+			      bool IsChanged) {
+  unsigned Slot;
+  bool Found = ValueState.getSlot(&Inst, Slot);
+  assert(Found && "updateState: instruction not in ValueState");
+  (void) Found;
+  updateState(Inst, Slot, NewV, IsChanged);
+}
 
-  if (NarrowingPass){
-    DEBUG(dbgs() << "***[Narrowing] from ");
-    DEBUG(OldV->print(dbgs()));
-    DEBUG(dbgs() << " to " );
-    DEBUG(NewV->print(dbgs()));
-    DEBUG(dbgs() << "\n" );
-    assert(NewV);
-    delete ValueState[&Inst];
-    ValueState[&Inst] = NewV;
-  }
-  else{
-    ////////////////////////////////////////////////////////////////////
-    // Widening:
-    //             bottom         if n=0
-    // f^{n}_{w} = f^{n-1}_{w}    if n>0 and 
-    //                            f(f^{n-1}_{w}) \subseteq f^{n-1}_{w}
-    //             widening(f^{n-1}_{w},f(f^{n-1}_{w})) otherwise
-    // Here OldV = f^{n-1}_{w} and NewV = f(f^{n-1}_{w})
-    ////////////////////////////////////////////////////////////////////
-    
-    if (I != ValueState.end() && NewV->lessOrEqual(OldV)){
-      // No change
-      DEBUG(dbgs() << "\nThere is no change\n");
-      // If uncommented then we produce a seg fault if debugging mode
-      // delete NewV
-      return;  
-    }
-    
-    NewV->incNumOfChanges();        
-    if (Widen(&Inst,NewV->getNumOfChanges())){
-      //dbgs() << "WIDENING " <<  Inst << "\n";
-
-      NumOfWidenings++;
-      NewV->widening(OldV,ConstSet);
-      // We reset the counter because we don't want to apply widening
-      // if not really needed. E.g., after a widening we can have a
-      // casting operation. If the counter is not reset then we will
-      // do widening again with potential catastrophic losses.
-      if (NewV->isLattice())
-	NewV->resetNumOfChanges();
-    }
-    // there is change: visit uses of I.
-    assert(NewV);
+void FixpointSSI::updateState(Instruction &Inst, unsigned Slot,
+			      AbstractValue * NewV, bool IsChanged) {
+  updateDomainState(Inst, Slot, NewV, IsChanged);
+}
 
-    delete ValueState[&Inst];
-    ValueState[&Inst] = NewV;
-    DEBUG(dbgs() << "***Added into I-WL: " << Inst << "\n");
+// During narrowing there is no widening and the value is replaced
+// even if it does not decrease.
+void FixpointSSI::narrowState(Instruction &Inst, unsigned Slot,
+			      AbstractValue * NewV) {
+  AbstractValue* OldV  = ValueState.get(Slot);
+  if (NarrowingStrategy == NARROWING_WORKLIST){
+    // Only changes are propagated so a stable value (or one that
+    // ran out of budget) stops here.
+    if (ValueState.getNumOfChanges(Slot) >= NarrowingLimit || 
+	NewV->isEqual(OldV))
+      return;
+    ValueState.incNumOfChanges(Slot);
     InstWorkList.insert(&Inst);
   }
+  DEBUG(dbgs() << "***[Narrowing] from ");
+  DEBUG(OldV->print(dbgs()));
+  DEBUG(dbgs() << " to " );
+  DEBUG(NewV->print(dbgs()));
+  DEBUG(dbgs() << "\n" );
+  // The narrowing passes replace the value even if it did not
+  // change. Only the costs need to know.
+  if (NarrowingStrategy == NARROWING_WORKLIST || 
+      (MeasureCosts && !NewV->isEqual(OldV)))
+    StateVersion++;
+  delete OldV;
+  ValueState.set(Slot, NewV);
+}
+
+AbstractValue* FixpointSSI::takeInductionRange(Instruction *I){
+  if (InductionRanges.empty())
+    return NULL;
+  DenseMap<Instruction*, AbstractValue*>::iterator It = InductionRanges.find(I);
+  if (It == InductionRanges.end())
+    return NULL;
+  AbstractValue *IV = It->second;
+  InductionRanges.erase(It);
+  return IV;
+}
+
+void FixpointSSI::countAcceleration(){
+  NumOfAccelerations++;
+}
+
+void FixpointSSI::countWidening(){
+  NumOfWidenings++;
+  Budget.widen();
 }
 
 // Special case for Boolean flags.
 void FixpointSSI::updateCondFlag(Instruction &I, TBool * New){  
   assert(isTrackedCondFlag(&I));  
   if (NarrowingPass){
+    if (NarrowingStrategy == NARROWING_WORKLIST){
+      if (TrackedCondFlags.lookup(&I)->isEqual(New)) return;
+      InstWorkList.insert(&I);
+      StateVersion++;
+    }
+    else if (MeasureCosts && !TrackedCondFlags.lookup(&I)->isEqual(New))
+      StateVersion++;
     delete TrackedCondFlags[&I];
     TrackedCondFlags[&I] = New;    
     return;
@@ -453,6 +634,7 @@ void FixpointSSI::updateCondFlag(Instruction &I, TBool * New){
   // There is change: visit uses of I.
   delete TrackedCondFlags[&I];
   TrackedCondFlags[&I] = New;
+  StateVersion++;
   DEBUG(dbgs() << "***Added into I-WL: " << I << "\n");
   InstWorkList.insert(&I);
 }
@@ -485,7 +667,8 @@ void FixpointSSI::markEdgeExecutable(BasicBlock *Source, BasicBlock *Dest) {
 void FixpointSSI::markBlockExecutable(BasicBlock *BB) {
   DEBUG(dbgs() << "***Marking Block Executable: " << BB->getName() << "\n");
   NumOfAnalBlocks++;  
-  BBExecutable.insert(BB);   // Basic block is executable  
+  // Basic block is executable  
+  if (BBExecutable.insert(BB)) StateVersion++;
 
 #ifdef SKIP_TRAP_BLOCKS
   DenseMap<BasicBlock*,unsigned int>::iterator It = TrackedTrapBlocks.find(BB);
@@ -497,139 +680,145 @@ void FixpointSSI::markBlockExecutable(BasicBlock *BB) {
 
 // visitInst - Execute the instruction
 void FixpointSSI::visitInst(Instruction &I) { 
+  unsigned N;
+  if (InstWorkList.lookupIndex(&I, N) && N < Program.size())
+    visitInst(Program[N]);
+  else
+    visitInst(decodeInst(I));
+}
 
-  NumOfAnalInsts++;
+/// Decode I following the same order of checks that visitInst
+/// applies.
+DecodedInst FixpointSSI::decodeInst(Instruction &I){
+  DecodedInst D;
+  D.I = &I;
+  D.Slot = D.Ops[0] = D.Ops[1] = DecodedInst::NO_SLOT;
+  D.IsSrcFlag = false;
 
   // First, special instructions handled directly by the fixpoint
   // algorithm, never passed into the underlying abstract domain
   // because they can be defined in terms of join, meet, etc.
+  if (isa<StoreInst>(&I))            D.Kind = DecodedInst::STORE;
+  else if (isa<LoadInst>(&I))        D.Kind = DecodedInst::LOAD;
+  else if (isa<CallInst>(&I))        D.Kind = DecodedInst::CALL;
+  else if (isa<ReturnInst>(&I))      D.Kind = DecodedInst::RETURN;
+  else if (isa<PHINode>(&I))         D.Kind = DecodedInst::PHI;
+  else if (isa<SelectInst>(&I))      D.Kind = DecodedInst::SELECT;
+  else if (isa<TerminatorInst>(&I))  D.Kind = DecodedInst::TERMINATOR;
+  else if (isa<ICmpInst>(&I))        D.Kind = DecodedInst::ICMP;
+  else if (IsBooleanLogicalOperator(&I)) D.Kind = DecodedInst::BOOLEAN;
+  else{
+    // Otherwise, the transfer function is passed to the abstract
+    // domain.
+    switch (I.getOpcode()){
+    case Instruction::Add:
+    case Instruction::Sub:
+    case Instruction::Mul:
+    case Instruction::SDiv:
+    case Instruction::UDiv:
+    case Instruction::SRem:
+    case Instruction::URem:
+      D.Kind = DecodedInst::ARITH;
+      break;
+    case Instruction::Shl:  // logical left shift
+    case Instruction::LShr: // logical right shift
+    case Instruction::AShr: // arithmetic right shift
+    case Instruction::And:  // bitwise and
+    case Instruction::Or:   // bitwise or
+    case Instruction::Xor:  // bitwise xor
+      D.Kind = DecodedInst::BITWISE;
+      break;
+    case Instruction::BitCast: // no-op cast from one type to another
+    case Instruction::ZExt:    // zero extend integers
+    case Instruction::SExt:    // sign extend integers
+    case Instruction::Trunc:   // truncate integers
+      D.Kind = DecodedInst::CAST;
+      D.IsSrcFlag = isTrackedCondFlag(I.getOperand(0));
+      break;
+    default:
+      D.Kind = DecodedInst::OTHER;
+    }
+    ValueState.getSlot(&I, D.Slot);
+    for (unsigned K=0, E=std::min(I.getNumOperands(), 2U); K < E; K++){
+      Value *Op = I.getOperand(K);
+      // Same as Lookup: undefined values are not tracked.
+      if (Op->getValueID() != Value::UndefValueVal)
+	ValueState.getSlot(Op, D.Ops[K]);
+    }
+  }
+  return D;
+}
 
-  if (StoreInst *SI  = dyn_cast<StoreInst>(&I))
-    return visitStoreInst(*SI);
-
-  if (LoadInst *LI   = dyn_cast<LoadInst>(&I))
-    return visitLoadInst(*LI);
-
-  if (CallInst *CI = dyn_cast<CallInst>(&I))
-    return visitCallInst(*CI);
-
-  if (ReturnInst *RI = dyn_cast<ReturnInst>(&I))
-    return visitReturnInst(*RI);
-
-  if (PHINode *PN = dyn_cast<PHINode>(&I))
-    return visitPHINode(*PN);
-
-  if (SelectInst *SelI = dyn_cast<SelectInst>(&I))
-    return visitSelectInst(*SelI);
+void FixpointSSI::visitInst(const DecodedInst &D) { 
 
-  if (TerminatorInst *TI = dyn_cast<TerminatorInst>(&I))
-    return visitTerminatorInst(*TI);
+  NumOfAnalInsts++;
+  Budget.visit();
+  if (!MeasureCosts){
+    dispatchInst(D);
+    return;
+  }
+  // Transfer functions can visit other instructions (e.g., the phi
+  // nodes of a block that becomes executable): their time and
+  // changes are charged to them, not to D.
+  uint64_t OuterNanos = NestedNanos;
+  unsigned OuterChanges = NestedChanges;
+  NestedNanos = 0;
+  NestedChanges = 0;
+  unsigned Version = StateVersion;
+  uint64_t Start = TransferCosts::now();
+  dispatchInst(D);
+  uint64_t Nanos = TransferCosts::now() - Start;
+  unsigned Changes = StateVersion - Version;
+  OpCosts.record(*D.I, Nanos - NestedNanos, Changes > NestedChanges);
+  NestedNanos = OuterNanos + Nanos;
+  NestedChanges = OuterChanges + Changes;
+}
 
-  if (ICmpInst *ICmpI = dyn_cast<ICmpInst>(&I))
-    return visitComparisonInst(*ICmpI);
-  
-  if (IsBooleanLogicalOperator(&I))
+void FixpointSSI::dispatchInst(const DecodedInst &D) { 
+
+  Instruction &I = *D.I;
+
+  switch (D.Kind){
+  case DecodedInst::STORE:
+    return visitStoreInst(cast<StoreInst>(I));
+  case DecodedInst::LOAD:
+    return visitLoadInst(cast<LoadInst>(I));
+  case DecodedInst::CALL:
+    return visitCallInst(cast<CallInst>(I));
+  case DecodedInst::RETURN:
+    return visitReturnInst(cast<ReturnInst>(I));
+  case DecodedInst::PHI:
+    return visitPHINode(cast<PHINode>(I));
+  case DecodedInst::SELECT:
+    return visitSelectInst(cast<SelectInst>(I));
+  case DecodedInst::TERMINATOR:
+    return visitTerminatorInst(cast<TerminatorInst>(I));
+  case DecodedInst::ICMP:
+    return visitComparisonInst(cast<ICmpInst>(I));
+  case DecodedInst::BOOLEAN:
     return visitBooleanLogicalInst(I);
+  default:
+    break;
+  }
   
   // Otherwise, we pass the transfer function to the abstract domain.
-  if (Value *V = dyn_cast<Value>(&I)){
-    if (AbstractValue * AbsV = ValueState.lookup(V)){ 
-
-      // New is going to keep a pointer to a derived class. The
-      // methods visitArithBinaryOp, visitBitwiseBinaryOp, and
-      // visitCast ensure that it is new allocated memory.
-      AbstractValue *New = NULL;
-      switch (I.getOpcode()){
-      case Instruction::Add: 
-      case Instruction::Sub:
-      case Instruction::Mul:
-      case Instruction::SDiv:
-      case Instruction::UDiv:
-      case Instruction::SRem:
-      case Instruction::URem:
-	{
-	  DEBUG(dbgs() << "Arithmetic instruction: " << I << "\n");
-	  /// 
-	  // We can have instructions like 
-	  // %tmp65 = sub i32 %tmp64, ptrtoint ([6 x %struct._IO_FILE*]* @xgets.F to i32)	    
-	  // Therefore, we need to check if the operands are in
-	  // ValueState. If not, just top.
-	  ////
-	  AbstractValue * Op1 = Lookup(I.getOperand(0), false);
-	  AbstractValue * Op2 = Lookup(I.getOperand(1), false);
-	  if (Op1 && Op2)
-	    New = AbsV->visitArithBinaryOp(Op1,Op2,
-					   I.getOpcode(),I.getOpcodeName());
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      case Instruction::Shl:  // logical left shift
-      case Instruction::LShr: // logical right shift    
-      case Instruction::AShr: // arithmetic right shift    
-      case Instruction::And:  // bitwise and
-      case Instruction::Or:   // bitwise or
-      case Instruction::Xor:  // bitwise xor
-	{
-	  DEBUG(dbgs() << "Bitwise instruction: " << I << "\n");
-	  AbstractValue * Op1 = Lookup(I.getOperand(0), false);
-	  AbstractValue * Op2 = Lookup(I.getOperand(1), false);
-	  if (Op1 && Op2)
-	    New =  AbsV->visitBitwiseBinaryOp(Op1, Op2,
-					      I.getOperand(0)->getType(), 
-					      I.getOperand(1)->getType(),
-					      I.getOpcode(), I.getOpcodeName());
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      case Instruction::BitCast: // no-op cast from one type to another
-      case Instruction::ZExt:    // zero extend integers
-      case Instruction::SExt:    // sign extend integers
-      case Instruction::Trunc:   // truncate integers
-	{
-	  DEBUG(dbgs() << "Casting instruction: " << I << "\n");	    
-	  // Tricky step: the source of the casting instruction may be
-	  // a Boolean Flag.  If yes, we need to convert the Boolean
-	  // flag into an abstract value. This must be done by the
-	  // class that implements AbstractValue.
-	  TBool * SrcFlag  = NULL;
-	  AbstractValue *SrcAbsV = NULL;	  
-	  if (isTrackedCondFlag(I.getOperand(0)))
-	    SrcFlag = TrackedCondFlags.lookup(I.getOperand(0));
-	  else
-	    SrcAbsV = Lookup(I.getOperand(0), false);
-
-	  if (SrcFlag || SrcAbsV)
-	    New =  AbsV->visitCast(I, SrcAbsV, SrcFlag, IsAllSigned);
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      default: 
+  if (D.Slot != DecodedInst::NO_SLOT){
+    AbstractValue * AbsV = ValueState.get(D.Slot);
+    if (visitTransferInst(D, AbsV))
+      return;
 #ifdef  WARNINGS
-	dbgs() << "Warning: transfer function not implemented: " << I << "\n"; 
+    dbgs() << "Warning: transfer function not implemented: " << I << "\n"; 
 #endif  /* WARNINGS */
-	assert(New == NULL);
-	New = AbsV->clone();
-	New->makeTop();
-	NumOfSkippedIns++;
-	break;
-      } // end switch
-      assert(New && "ERROR: something wrong during the transfer function ");
-      PRINTCALLER("visitInst");
-      // We do not delete New since it will be stored in a map
-      // manipulated by updateState. Instead, updateState will free
-      // the old value if it is replaced with New.
-      updateState(I,New);
-    }
-  } 
+    AbstractValue *New = AbsV->clone();
+    New->makeTop();
+    NumOfSkippedIns++;
+    PRINTCALLER("visitInst");
+    updateState(I, D.Slot, New, false);
+  }
+}
+
+bool FixpointSSI::visitTransferInst(const DecodedInst &D, AbstractValue *AbsV){
+  return transferInst(D, AbsV);
 }
 
 // Function calls
@@ -650,7 +839,7 @@ FunctionWithoutCode(CallInst *CInst, Function * Callee, Instruction *I){
       DEBUG(dbgs() << "\n");
     }
     else{
-      if (AbstractValue * LHS = ValueState[I]){
+      if (AbstractValue * LHS = ValueState.lookup(I)){
 	DEBUG(dbgs() << "\tMaking the return value top: ");
 	LHS->makeTop();
 	DEBUG(LHS->print(dbgs()));
@@ -738,8 +927,7 @@ void FixpointSSI::addTrackedGlobalVariables(Module *M) {
 	      TrackedCondFlags.insert(std::make_pair(&*Gv, new TBool()));
 	  }
 	  else	
-	      ValueState.insert(std::make_pair(&*Gv,
-					       initAbsValIntConstant(Gv,GvInitVal)));
+	      ValueState.insert(&*Gv, initAbsValIntConstant(Gv,GvInitVal));
 	}
       }
       else{
@@ -755,7 +943,7 @@ void FixpointSSI::addTrackedGlobalVariables(Module *M) {
 	    cast<ConstantInt>(ConstantInt::
 			      get(Gv->getType()->getContainedType(0),
 				  0, IsAllSigned));
-	  ValueState.insert(std::make_pair(&*Gv,initAbsValIntConstant(Gv,Zero)));
+	  ValueState.insert(&*Gv,initAbsValIntConstant(Gv,Zero));
 	}
 	}
       TrackedGlobals.insert(Gv);
@@ -782,7 +970,7 @@ void FixpointSSI::addTrackedGlobalVariablesPessimistically(Module *M) {
 	  TrackedCondFlags.insert(std::make_pair(&*Gv,new TBool()));	      
       }
       else
-	ValueState.insert(std::make_pair(&*Gv,initAbsValTop(Gv)));
+	ValueState.insert(&*Gv,initAbsValTop(Gv));
       TrackedGlobals.insert(Gv);
     }    
   }
@@ -800,6 +988,7 @@ void FixpointSSI::visitStoreInst(StoreInst &I){
 	TBool * MemAddFlag = TrackedCondFlags[I.getPointerOperand()];    
 	assert(MemAddFlag && "Memory location not mapped to a Boolean flag");
 	DEBUG(dbgs() << "Memory store " << I << "\n");	  
+	TBool OldFlag(*MemAddFlag);
 	if (isTrackedCondFlag(I.getValueOperand())){
 	  TBool * FlagToStore = TrackedCondFlags[I.getValueOperand()];
 	  // weak update using disjunction
@@ -807,6 +996,7 @@ void FixpointSSI::visitStoreInst(StoreInst &I){
 	}
 	else
 	  MemAddFlag->makeMaybe();
+	if (!OldFlag.isEqual(MemAddFlag)) StateVersion++;
 
 	DEBUG(dbgs() <<"\t[RESULT] ");
 	DEBUG(MemAddFlag->print(dbgs()));
@@ -817,7 +1007,9 @@ void FixpointSSI::visitStoreInst(StoreInst &I){
       assert(MemAddr && "Memory location is not mapped in ValueState");	
       DEBUG(dbgs() << "Memory store " << I << "\n");	  
       // Weak update
-      MemAddr->join(Lookup(I.getValueOperand(), true));	
+      AbstractValue * StoredV = Lookup(I.getValueOperand(), true);
+      if (!StoredV->lessOrEqual(MemAddr)) StateVersion++;
+      MemAddr->join(StoredV);	
       DEBUG(dbgs() <<"\t[RESULT] ");
       DEBUG(MemAddr->print(dbgs()));
       DEBUG(dbgs() <<"\n");      
@@ -911,14 +1103,7 @@ void insertTrackedValuesUsedSigmaNode(SigmaUsersTy &TrackedValuesUsedSigmaNode,
   
   if (!isa<ConstantInt>(V)){
     DEBUG(dbgs() << "Adding " << V->getName() << " -> " << LHSSigma->getName() << "\n");
-    if (SmallValueSet * SigmaSet = TrackedValuesUsedSigmaNode[V]){
-      SigmaSet->insert(LHSSigma);
-    }
-    else{
-      SmallValueSet * NSigmaSet = new SmallValueSet;
-      NSigmaSet->insert(LHSSigma);
-      TrackedValuesUsedSigmaNode[V] = NSigmaSet; 
-    }
+    TrackedValuesUsedSigmaNode.push_back(std::make_pair(V, LHSSigma));
   }
 }
 
@@ -1102,42 +1287,24 @@ void normalizeConstraint(BinaryConstraintPtr & FPtr, Value *V){
   }    
 }
 
-/// Execute the filters generated for RHSSigma and store the result in
-/// LHSSigma.
-bool FixpointSSI::evalFilter(AbstractValue * &LHSSigma, Value *RHSSigma){
-  bool FilteredDone=false;
-  SigmaFiltersTy::iterator I = SigmaFilters.find(LHSSigma->getValue());
-  if (I != SigmaFilters.end()){
-    BinaryConstraintPtr C = (*I).second;
-    DEBUG(dbgs() << "Evaluating filter constraints: "; C.get()->print();  dbgs() << "\n");
-    normalizeConstraint(C,RHSSigma);
-    DEBUG(dbgs() << "After normalization          : "; C.get()->print();  dbgs() << "\n");
-    // After normalization we know that Op1 is the default value for
-    // LHS which we hope to refine by using Op2.
-    AbstractValue * Op1 = Lookup(C.get()->getOperand(0), true);
-    AbstractValue * Op2 = Lookup(C.get()->getOperand(1), true);
-    
-    // This is too restrictive: If Op1 is already top then we do not
-    // bother.
-    // if (Op1->IsTop()){ LHSSigma->makeTop(); break; } 
-    
-    // Here we cannot filter since Op2 is top.
-    if (Op2->IsTop()) return false;
-    if (Op2->isBot()) return false;
-    
-    unsigned pred       = C.get()->getPred();
-    DEBUG( LHSSigma->print(dbgs()); dbgs() << "\n");
-    DEBUG( Op1->print(dbgs()); dbgs() << "\n");
-    DEBUG( Op2->print(dbgs()); dbgs() << "\n");     
-
-    // Do not remember why I cloned here but it does not make sense.
-    // LHSSigma->filterSigma(pred, Op1->clone(), Op2->clone());
-    LHSSigma->filterSigma(pred, Op1, Op2);
-
-    DEBUG( LHSSigma->print(dbgs()); dbgs() << "\n");
-    FilteredDone=true;
-  }
-  return FilteredDone;
+/// Return the filter generated for LHSSigma after normalizing it
+/// with respect to RHSSigma (see sigmaNode).
+bool FixpointSSI::getSigmaFilter(Value *LHSSigma, Value *RHSSigma, 
+				 unsigned &Pred, 
+				 AbstractValue *&Op1, AbstractValue *&Op2){
+  SigmaFiltersTy::iterator I = SigmaFilters.find(LHSSigma);
+  if (I == SigmaFilters.end())
+    return false;
+  BinaryConstraintPtr C = (*I).second;
+  DEBUG(dbgs() << "Evaluating filter constraints: "; C.get()->print();  dbgs() << "\n");
+  normalizeConstraint(C,RHSSigma);
+  DEBUG(dbgs() << "After normalization          : "; C.get()->print();  dbgs() << "\n");
+  Op1  = Lookup(C.get()->getOperand(0), true);
+  Op2  = Lookup(C.get()->getOperand(1), true);
+  Pred = C.get()->getPred();
+  DEBUG( Op1->print(dbgs()); dbgs() << "\n");
+  DEBUG( Op2->print(dbgs()); dbgs() << "\n");     
+  return true;
 }
 
 
@@ -1183,185 +1350,14 @@ bool FixpointSSI::evalFilter(AbstractValue * &LHSSigma, Value *RHSSigma){
 //   return FilteredDone;
 // }
 
-/// Simply assign RHSSigma to LHSSigma.
-void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma){
-  // In programs like 176.gcc we have things like:
-  //  %.01.i = phi i32 [ ptrtoint (double* getelementptr inbounds 
-  //                     (%struct.fooalign* null, i32 0, i32 1) to i32), 
-  //                     %bb3.i ]
-  // Thus, we can raise an exception if RHSSigma is not found.
-
-  ResetAbstractValue(LHSSigma);
-  if (AbstractValue *AbsVal = Lookup(RHSSigma,false))
-    LHSSigma->join(AbsVal);
-  else
-    LHSSigma->makeTop();
-}
-
-// Execute a sigma node in two steps. The execution consists of
-// assigning RHSSigma to LHSSigma. Additionally, knowledge from BI is
-// used to improve LHSSigma. First it generates any filter that it can
-// be inferred from the branch condition. Second, it actually executes
-// the filter.
-void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma,
-				 BasicBlock *SigmaBB, BranchInst * BI){				 
-  // FiltersTy filters;
-  // generateFilters(LHSSigma->getValue(), RHSSigma, BI, SigmaBB, filters);
-
-  SigmaFiltersTy::iterator I = SigmaFilters.find(LHSSigma->getValue());
-  if (I == SigmaFilters.end())
-    generateFilters(LHSSigma->getValue(), RHSSigma, BI, SigmaBB);
-
-  
-  if (!evalFilter(LHSSigma, RHSSigma /*, filters*/)){
-    // Assign RHSSigma to LHSSigma
-    ResetAbstractValue(LHSSigma);
-    // LHSSigma->join(Lookup(RHSSigma,true));
-    if (AbstractValue * AbsVal = Lookup(RHSSigma,false))
-      LHSSigma->join(AbsVal);
-    else
-      LHSSigma->makeTop();
-
-  }
-}
-
-
-/// Special case if the underlying domain is a non-lattice.  The
-/// implementation of visitPHINode assumes that the underlying
-/// abstract domain is associative. That is, join(join(x,y)),z) =
-/// join(x, join(y,z)). However, non-lattice joins are not
-/// associative. In that case, we prefer not to join directly all the
-/// incoming values since different orders although sound may give
-/// different levels of precision. Instead, we just collect all
-/// incoming values and put them into a vector which is passed
-/// directly to the non-lattice domain which knows how to deal with
-/// this lack of associativity.
-void FixpointSSI::visitPHINode(AbstractValue *&AbsValNew, PHINode &PN){
-
-  bool must_be_top=false;
-  std::vector<AbstractValue*> AbsIncVals;
-  
-  for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
-    if (isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()) && 
-	(PN.getIncomingValue(i)->getValueID() != Value::UndefValueVal)){				   
-      AbstractValue * AbsIncVal = Lookup(PN.getIncomingValue(i),false);
-      if (!AbsIncVal){
-	must_be_top = true;
-	break;
-      }
-      else
-	AbsIncVals.push_back(AbsIncVal);
-    }
-  } // end for
-  if (must_be_top)
-    AbsValNew->makeTop();
-  else
-    AbsValNew->GeneralizedJoin(AbsIncVals);
-  
-  PRINTCALLER("visitPHI");
-  updateState(PN,AbsValNew);
-  DEBUG(dbgs() << "\t[RESULT] ");
-  DEBUG(AbsValNew->print(dbgs()));
-  DEBUG(dbgs() << "\n");        
-}
-
-/// This method covers actually two different instructions. A sigma
-/// node is represented as a phi node but with a single incoming
-/// block.
-///
-/// If a sigma node then it attempts at improving the precision of the
-/// value by restricting it using information from the conditional
-/// branch of the incoming block of the sigma node.
-///
-/// If a phi node then it merges the values only from feasible
-/// predecessors.
-
+/// Execute a PHI or sigma node if it is tracked.
 void FixpointSSI::visitPHINode(PHINode &PN) {
-  if (Value *V = dyn_cast<Value>(&PN)){
-    if (AbstractValue * AbsVal = Lookup(V, false)){       
-      if (PN.getNumIncomingValues() == 1){
-	// Sigma node is represented as a phi node with exactly one
-	// incoming value.
-	DEBUG(dbgs() << "Sigma node " << PN << "\n");
-	AbstractValue * NewAbsVal = AbsVal->clone();  	
-	if (TerminatorInst * TI  = PN.getIncomingBlock(0)->getTerminator()){
-	  if (BranchInst * BI  = dyn_cast<BranchInst>(TI)){
-	    //assert(BI->isConditional());
-	    if (BI->isConditional())
-	      visitSigmaNode(NewAbsVal, PN.getIncomingValue(0), PN.getParent(), BI);
-	    else
-	      visitSigmaNode(NewAbsVal, PN.getIncomingValue(0));
-	  }
-	}
-	PRINTCALLER("visitSigmaNode");
-	// We do not delete NewAbsVal since it will be stored in a map
-	// manipulated by updateState. Instead, updateState will free
-	// the old value if it is replaced with NewAbsVal.
-	updateState(PN,NewAbsVal);
+  if (AbstractValue * AbsVal = Lookup(&PN, false))
+    visitPHINode(PN, AbsVal);
+}
 
-	DEBUG(dbgs() << "\t[RESULT] ");
-	DEBUG(NewAbsVal->print(dbgs()));
-	DEBUG(dbgs() << "\n");        
-      } 
-      else{
-	// PHI node
-	AbstractValue *AbsValNew = AbsVal->clone();
-	//ResetAbstractValue(AbsValNew);
-	AbsValNew->makeBot();
-
-	DEBUG(dbgs() << "PHI node " << PN << "\n");
-
-	// If the abstract domain is not a lattice then we call go
-	// GeneralizedJoin, a special version, for joining multiple
-	// abstract values. If the abstract domain is a lattice we
-	// don't need such a specialized method since we can use the
-	// binary join repeatedly without losing precision. For a
-	// non-lattice domain is not the case (see our SAS'13 paper).
-	if (!(AbsValNew->isLattice()))
-	  visitPHINode(AbsValNew,PN);
-	else{	  
-	  for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
-	    // if (!isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()))
-	    //   dbgs() << PN.getIncomingBlock(i)->getName()
-	    // 	     << " --> " << PN.getParent()->getName()  << " IS UNREACHABLE\n";
-	    // else{
-	    //   dbgs() << PN.getIncomingBlock(i)->getName() 
-	    // 	     << " --> " << PN.getParent()->getName()  << " IS REACHABLE\n";
-	    // }
-	    if (isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()) && 
-		(PN.getIncomingValue(i)->getValueID() != Value::UndefValueVal)){				   
-	      /// Merging values: since join can only lose precision
-	      /// we stop if we already reach top.
-	      
-	      if (AbsValNew->IsTop()){ 
-		DEBUG(dbgs() << "Skipped " << *(PN.getIncomingValue(i)) 
-		             << " because already top!\n");
-		break;	       
-	      }
-	      AbstractValue * AbsIncVal = Lookup(PN.getIncomingValue(i),false);
-	      DEBUG(dbgs() << "Merging " << *(PN.getIncomingValue(i)) << "\n");
-	      if (!AbsIncVal){
-		AbsValNew->makeTop();
-		DEBUG(dbgs() << "Could not find " << *(PN.getIncomingValue(i)) 
-		             << " in the lookup table. \n");
-		break;
-	      }
-	      else
-		AbsValNew->join(AbsIncVal);
-	    }
-	  } // end for
-	  PRINTCALLER("visitPHI");
-	  // We do not delete NewAbsVal since it will be stored in a map
-	  // manipulated by updateState. Instead, updateState will free
-	  // the old value if it is replaced with NewAbsVal.
-	  updateState(PN,AbsValNew);
-	  DEBUG(dbgs() << "\t[RESULT] ");
-	  DEBUG(AbsValNew->print(dbgs()));
-	  DEBUG(dbgs() << "\n");        
-	} 
-      }
-    }
-  }
+void FixpointSSI::visitPHINode(PHINode &PN, AbstractValue *AbsVal) {
+  phiNode(PN, AbsVal);
 }
 
 /// Join the abstract values of the two operands and store it in the
@@ -1535,31 +1531,30 @@ void FixpointSSI::visitTerminatorInst(TerminatorInst &TI){
   llvm_unreachable("Found an unsupported terminator instruction.");
 }
 
-// Reduce the number of cases. After calling getPredicate and
-// swap, only six cases: EQ, NEQ, SLE, ULE, ULT, and SLT
-// 
-// Important: for some reason if an instruction is swap it may disable
-// some def-use chains. This causes to reach too early fixpoints
-// (e.g., test-unbounded-loop-3.c). This weird behaviour is not
-// documented so it's hard to see why. Our solution is to clone the
-// instruction which we want to swap. However, we have to be careful
-// since if we try to lookup in one of our tables using that cloned
-// instruction the search will fail.
-ICmpInst * normalizeCmpInst(ICmpInst &I){
-  ICmpInst *II = cast<ICmpInst>(I.clone());
-  switch (II->getPredicate()){
+// Reduce the number of cases. After swapping the operands of the
+// "greater" predicates, only six cases: EQ, NEQ, SLE, ULE, ULT, and
+// SLT.
+//
+// The instruction itself is not changed (swapping its operands may
+// disable some def-use chains) and no clone is made either: a clone
+// adds itself to the use lists of its operands, and constants and
+// globals are shared by all the functions that the workers of -jobs
+// analyze at the same time.
+static CmpInst::Predicate 
+normalizeCmpInst(ICmpInst &I, Value *&Op1, Value *&Op2){
+  Op1 = I.getOperand(0);
+  Op2 = I.getOperand(1);
+  CmpInst::Predicate Pred = I.getPredicate();
+  switch (Pred){
   case ICmpInst::ICMP_UGT:	
   case ICmpInst::ICMP_SGT:	
-    II->swapOperands();
-    break;
   case ICmpInst::ICMP_UGE:	
   case ICmpInst::ICMP_SGE:	
-    II->swapOperands();
-    break;
+    std::swap(Op1, Op2);
+    return ICmpInst::getSwappedPredicate(Pred);
   default: 
-    ;
+    return Pred;
   }
-  return II;
 }
 
 
@@ -1673,9 +1668,8 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
 
   DEBUG(dbgs() << "Comparison instruction: " << I << "\n");
   if (!isTrackedCondFlag(&I)) return;
-  // May swap operands of I: don't do lookups using ClonedI as a base
-  // pointer !!
-  ICmpInst* ClonedI = normalizeCmpInst(I);    
+  Value *V1, *V2;
+  CmpInst::Predicate Pred = normalizeCmpInst(I, V1, V2);
   // Make sure we make a copy here
   TBool *LHS = new TBool(*TrackedCondFlags.lookup(&I));
 
@@ -1689,8 +1683,8 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
   // assertion in that case. Instead, we just make "maybe" the lhs of
   // the instruction.
   ///////////////////////////////////////////////////////////////////////////////
-  if (AbstractValue *Op1 = Lookup(ClonedI->getOperand(0), false)){
-    if (AbstractValue *Op2 = Lookup(ClonedI->getOperand(1), false)){
+  if (AbstractValue *Op1 = Lookup(V1, false)){
+    if (AbstractValue *Op2 = Lookup(V2, false)){
       if (Op1->isBot() || Op2->isBot()){
 	// LHS->makeBottom();
 	// It is more conservative this:
@@ -1702,8 +1696,8 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
 	LHS->makeMaybe();
 	goto END;
       }
-      // Cloned has been already normalized (removed some cases)
-      switch (ClonedI->getPredicate()){
+      // Pred has been already normalized (removed some cases)
+      switch (Pred){
       case ICmpInst::ICMP_EQ:
 	comparisonEqInst(*LHS,Op1,Op2,IsMeetEmpty(Op1,Op2),ICmpInst::ICMP_EQ);
 	break;
@@ -1733,7 +1727,6 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
   LHS->makeMaybe();
 
  END:  
-  delete ClonedI;      
   DEBUG(dbgs() << "\t[RESULT]");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");          
@@ -1814,6 +1807,121 @@ bool FixpointSSI::Widen(Instruction* I, unsigned NumChanges){
 	   (NumChanges >= WideningLimit));
 }    
 
+/// Find the widening points of F that are induction variables of the
+/// form:
+/// \verbatim
+/// header:
+///   i  = phi [C, preheader], [i', latch]
+///   c  = icmp slt i, N
+///   br c, body, exit
+/// body:
+///   s  = phi [i, header]     ; sigma node filtered by i < N
+///   ...
+///   i' = add s, K
+/// \endverbatim
+/// where C, N and K are constants, and record their closed form: the
+/// sigma node goes from C to the last value that satisfies the
+/// filter and i one step further. The closed form is only a guess
+/// (e.g., the body may also assign i) but the fixpoint is checked as
+/// usual from there (see updateState), so the results are still
+/// sound if the guess is wrong.
+void FixpointSSI::addInductionVariables(Function *F){
+  for (DenseMap<Instruction*,unsigned>::iterator I = WideningPoints.begin(),
+	 E = WideningPoints.end(); I != E; ++I){
+    PHINode *PN = dyn_cast<PHINode>(I->first);
+    APInt Lo, Hi;
+    if (!PN || !getInductionRange(PN, Lo, Hi)) continue;
+    if (AbstractValue *IV = initAbsValInterval(PN, Lo, Hi)){
+      DEBUG(dbgs() << "Induction variable " << PN->getName() << ": ");
+      DEBUG(IV->print(dbgs()));
+      DEBUG(dbgs() << "\n");
+      NumOfInductionVars++;
+      InductionRanges[PN] = IV;
+    }
+  }
+}
+
+/// If PN is an induction variable (see addInductionVariables) return
+/// true and its range [Lo,Hi].
+bool FixpointSSI::getInductionRange(PHINode *PN, APInt &Lo, APInt &Hi){
+  if (PN->getNumIncomingValues() != 2) return false;
+  for (unsigned In=0; In < 2; In++){
+    ConstantInt *Init = dyn_cast<ConstantInt>(PN->getIncomingValue(In));
+    BinaryOperator *Next = dyn_cast<BinaryOperator>(PN->getIncomingValue(1-In));
+    if (!Init || !Next) continue;
+    // Next = Sigma + K or Sigma - K
+    Value *Sigma = Next->getOperand(0);
+    ConstantInt *K = dyn_cast<ConstantInt>(Next->getOperand(1));
+    if (!K && Next->getOpcode() == Instruction::Add){
+      Sigma = Next->getOperand(1);
+      K = dyn_cast<ConstantInt>(Next->getOperand(0));
+    }
+    if (!K || K->isZero() || 
+	(Next->getOpcode() != Instruction::Add && 
+	 Next->getOpcode() != Instruction::Sub))
+      continue;
+    APInt Step = K->getValue();
+    if (Next->getOpcode() == Instruction::Sub) Step = -Step;
+
+    // The sigma node of PN on the path to Next and its filter.
+    PHINode *SN = dyn_cast<PHINode>(Sigma);
+    if (!SN || SN->getNumIncomingValues() != 1 || SN->getIncomingValue(0) != PN)
+      continue;
+    SigmaFiltersTy::iterator It = SigmaFilters.find(SN);
+    if (It == SigmaFilters.end()) continue;
+    BinaryConstraint C(*It->second.get());
+    if (isa<ConstantInt>(C.getOperand(0))) C.swap();
+    ConstantInt *N = dyn_cast<ConstantInt>(C.getOperand(1));
+    if (C.getOperand(0) != PN || !N) continue;
+
+    // Last value of the sigma node. Filters use signed predicates.
+    const APInt &Start = Init->getValue(), &Bound = N->getValue();
+    bool Up = Step.isStrictlyPositive();
+    APInt Last;
+    switch (C.getPred()){
+    case ICmpInst::ICMP_SLT:
+      if (!Up || !Start.slt(Bound)) continue;
+      Last = Bound - 1;
+      break;
+    case ICmpInst::ICMP_SLE:
+      if (!Up || !Start.sle(Bound)) continue;
+      Last = Bound;
+      break;
+    case ICmpInst::ICMP_SGT:
+      if (Up || !Start.sgt(Bound)) continue;
+      Last = Bound + 1;
+      break;
+    case ICmpInst::ICMP_SGE:
+      if (Up || !Start.sge(Bound)) continue;
+      Last = Bound;
+      break;
+    case ICmpInst::ICMP_NE:
+      // Only if the bound is hit exactly.
+      if (Up ? !Start.slt(Bound) : !Start.sgt(Bound)) continue;
+      if ((Bound - Start).srem(Step) != 0) continue;
+      Last = Bound - Step;
+      break;
+    default:
+      continue;
+    }
+    // PN goes one step further than the sigma node.
+    bool Overflow;
+    APInt Past = Last.sadd_ov(Step, Overflow);
+    if (Overflow) continue;
+    Lo = (Up ? Start : Past);
+    Hi = (Up ? Past : Start);
+    return true;
+  }
+  return false;
+}
+
+/// Return the value of B in Loops or Default if it is not there.
+static unsigned findLoop(const std::map<BasicBlock*,unsigned> &Loops, 
+			 BasicBlock *B, unsigned Default){
+  std::map<BasicBlock*,unsigned>::const_iterator It = Loops.find(B);
+  return (It == Loops.end() ? Default : It->second);
+}
+
 ///  This procedure is vital for the termination of the analysis since
 ///  it decides which points must be widen so that the analysis can
 ///  terminate. If we miss a point then we are in trouble.  We
@@ -1824,20 +1932,37 @@ bool FixpointSSI::Widen(Instruction* I, unsigned NumChanges){
 ///  Moreover, we also consider some load instructions done in the
 ///  destination block of backedges. In particular, where global
 ///  variables of interest are involved.
+///
+///  With the WTO iteration strategy the heads of the components play
+///  the role of the destination blocks of backedges.
 void FixpointSSI::addTrackedWideningPoints(Function * F){
-  if (WideningLimit > 0){    
-    SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
-    FindFunctionBackedges(*F, BackEdges);    
+  // The widening points are also needed if the budget can be exceeded
+  // (see updateState).
+  if (WideningLimit > 0 || Budget.hasLimits()){    
     // DestBackEdgeBB - Set of destination blocks of backedges
     SmallPtrSet<const BasicBlock*,16> DestBackEdgeBB;
-
-    for (SmallVector<std::pair<const BasicBlock*,const BasicBlock*>,32>::iterator 
-	   I = BackEdges.begin(),E = BackEdges.end(); I != E; ++I){
-      // DEBUG(dbgs() << "backedge from" << I->first->getName() << " to " << 
-      // 	  I->second->getName() << "\n");
-      DestBackEdgeBB.insert(I->second);    
+    if (IterationStrategy == WTO){
+      for (WeakTopologicalOrder::iterator 
+	     I = CFGOrder.begin(), E = CFGOrder.end(); I != E; ++I){
+	if (I->isHead()) DestBackEdgeBB.insert(I->Block);
+      }
+    }
+    else{
+      SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
+      FindFunctionBackedges(*F, BackEdges);    
+      for (SmallVector<std::pair<const BasicBlock*,const BasicBlock*>,32>::iterator 
+	     I = BackEdges.begin(),E = BackEdges.end(); I != E; ++I){
+	// DEBUG(dbgs() << "backedge from" << I->first->getName() << " to " << 
+	// 	  I->second->getName() << "\n");
+	DestBackEdgeBB.insert(I->second);    
+      }
     }
     
+    // Landmarks of the loop of each destination block of backedges.
+    std::map<BasicBlock*,unsigned> LoopLandmarks;
+    if (UseLoopLandmarks)
+      addLoopLandmarks(F, LoopLandmarks);
+    
     DEBUG(dbgs() << "Widening points: \n");
     for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I){
       // A phi node that is in the destination block of a backedge
@@ -1846,7 +1971,7 @@ void FixpointSSI::addTrackedWideningPoints(Function * F){
 	  if (DestBackEdgeBB.count(PN->getParent())){
 	    DEBUG(dbgs() << "\t" << *I << "\n");
 	    NumOfWideningPts++;
-	    WideningPoints.insert(&*I);
+	    WideningPoints[&*I] = findLoop(LoopLandmarks, I->getParent(), NO_LANDMARKS);
 	  }
 	}
       }
@@ -1859,7 +1984,7 @@ void FixpointSSI::addTrackedWideningPoints(Function * F){
 	      DestBackEdgeBB.count(I->getParent())){
 	    DEBUG(dbgs() << "\t" << *I << "\n");
 	    NumOfWideningPts++;
-	    WideningPoints.insert(&*I);
+	    WideningPoints[&*I] = findLoop(LoopLandmarks, I->getParent(), NO_LANDMARKS);
 	  }
 	}
       }
@@ -1868,17 +1993,191 @@ void FixpointSSI::addTrackedWideningPoints(Function * F){
   }  
 }
 
+/// Collect the landmarks of each loop of F and map its header to
+/// them in Loops. The landmarks of a loop are the limits of common
+/// widths plus the constants (and their neighbours) that appear in
+/// the blocks of the loop, inner loops included. These are the
+/// constants of its exit conditions and of its body, the ones that
+/// can bound the values of the loop.
+///
+/// With the WTO iteration strategy the loops are the components of
+/// the WTO. Otherwise, they are the natural loops of the backedges
+/// (the loops of the backedges of the same header are merged).
+void FixpointSSI::addLoopLandmarks(Function *F, 
+				   std::map<BasicBlock*,unsigned> &Loops){
+  std::map<BasicBlock*, std::set<BasicBlock*> > Blocks;
+  if (IterationStrategy == WTO){
+    for (unsigned i=0, e=CFGOrder.size(); i < e; i++){
+      if (!CFGOrder[i].isHead()) continue;
+      std::set<BasicBlock*> &Loop = Blocks[CFGOrder[i].Block];
+      for (unsigned j=i; j < i + CFGOrder[i].Size; j++)
+	Loop.insert(CFGOrder[j].Block);
+    }
+  }
+  else{
+    SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
+    FindFunctionBackedges(*F, BackEdges);    
+    for (unsigned i=0, e=BackEdges.size(); i < e; i++){
+      BasicBlock *Latch  = const_cast<BasicBlock*>(BackEdges[i].first);
+      BasicBlock *Header = const_cast<BasicBlock*>(BackEdges[i].second);
+      // Blocks that reach the latch without going through the header.
+      std::set<BasicBlock*> &Loop = Blocks[Header];
+      Loop.insert(Header);
+      std::vector<BasicBlock*> Stack;
+      if (Loop.insert(Latch).second) Stack.push_back(Latch);
+      while (!Stack.empty()){
+	BasicBlock *B = Stack.back();
+	Stack.pop_back();
+	for (pred_iterator PI = pred_begin(B), PE = pred_end(B); PI != PE; ++PI){
+	  if (Loop.insert(*PI).second) Stack.push_back(*PI);
+	}
+      }
+    }
+  }
+
+  for (std::map<BasicBlock*, std::set<BasicBlock*> >::iterator 
+	 I = Blocks.begin(), E = Blocks.end(); I != E; ++I){
+    std::set<int64_t> Set;
+    Utilities::recordLimitConstants(Set);
+    for (std::set<BasicBlock*>::iterator B = I->second.begin(), 
+	   BE = I->second.end(); B != BE; ++B){
+      for (BasicBlock::iterator Inst = (*B)->begin(), IE = (*B)->end(); 
+	   Inst != IE; ++Inst)
+	Utilities::recordIntegerConstants(&*Inst, Set);
+    }
+    Loops[I->first] = Landmarks.size();
+    Landmarks.push_back(std::vector<int64_t>(Set.begin(), Set.end()));
+    sortLandmarks(Landmarks.back());
+    NumOfLoopLandmarks += Set.size();
+    DEBUG(dbgs() << "Landmarks of the loop of " << I->first->getName() << ": ");
+    DEBUG(Utilities::printIntConstants(Landmarks.back()));
+  }
+}
+
+/// The widening operators search the landmarks assuming this order.
+void FixpointSSI::sortLandmarks(std::vector<int64_t> &Set){
+  if (ConstSetOrder == LESS_THAN){
+    // Since Set is ordered already using signed < we don't need to
+    // do anything here.
+    // std::sort(Set.begin(), Set.end()); 
+  }
+  else if (ConstSetOrder == LEX_LESS_THAN)
+    std::sort(Set.begin(), Set.end(), Utilities::Lex_LessThan_Comp);
+  else 
+    llvm_unreachable("Unsupported ordering");
+}
+
+const std::vector<int64_t> & FixpointSSI::getLandmarks(Instruction *I){
+  DenseMap<Instruction*,unsigned>::iterator It = WideningPoints.find(I);
+  if (It == WideningPoints.end() || It->second == NO_LANDMARKS)
+    return ConstSet;
+  return Landmarks[It->second];
+}
+
+///  Number the blocks and instructions of F in reverse post-order so
+///  that the worklists visit definitions before their uses (except
+///  along backedges). This makes the fixpoint deterministic: with an
+///  ordering based on addresses the number of iterations and even
+///  the effect of widening could change from run to run.
+void FixpointSSI::numberInstructions(Function * F){
+  ReversePostOrderTraversal<Function*> RPOT(F);
+  for (ReversePostOrderTraversal<Function*>::rpo_iterator 
+	 BI = RPOT.begin(), BE = RPOT.end(); BI != BE; ++BI){
+    BasicBlock *BB = *BI;
+    BBWorkList.addElement(BB);
+    BlockBegin.push_back(InstWorkList.getNumElements());
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+      InstWorkList.addElement(&*I);
+  }
+  BlockBegin.push_back(InstWorkList.getNumElements());
+}
+
+/// Decode once all the numbered instructions of F. Must be called
+/// when all the values of F have their slots in ValueState.
+void FixpointSSI::decodeInstructions(Function *F){
+  Program.reserve(InstWorkList.getNumElements());
+  for (unsigned N = 0, E = InstWorkList.getNumElements(); N < E; N++)
+    Program.push_back(decodeInst(*InstWorkList.getElement(N)));
+  DEBUG(dbgs() << "Decoded " << Program.size() << " instructions of " 
+	<< F->getName() << "\n");
+}
+
+/// Generate the filters of all the sigma nodes of F in advance so
+/// that buildDefUseGraph knows all the variables each sigma node
+/// depends on.
+void FixpointSSI::addTrackedSigmaFilters(Function *F){
+  for (Function::iterator B = F->begin(), BE = F->end(); B != BE; ++B){
+    for (BasicBlock::iterator I = B->begin(), IE = B->end(); I != IE; ++I){
+      PHINode *PN = dyn_cast<PHINode>(I);
+      if (!PN) break; // PHI nodes are always at the beginning
+      // Sigma node is represented as a phi node with exactly one
+      // incoming value.
+      if (PN->getNumIncomingValues() != 1 || !ValueState.lookup(PN)) 
+	continue;
+      if (BranchInst *BI = 
+	  dyn_cast<BranchInst>(PN->getIncomingBlock(0)->getTerminator())){
+	if (BI->isConditional())
+	  generateFilters(PN, PN->getIncomingValue(0), BI, &*B);
+      }
+    }
+  }
+}
+
+/// Record for each instruction its users, plus the sigma nodes whose
+/// filters use it (see TrackedValuesUsedSigmaNode), without
+/// duplicates. Nodes are the indexes of InstWorkList. Users that can
+/// never be visited are dropped: the instruction itself, users in
+/// unreachable blocks (they were not numbered) and users in trap
+/// blocks.
+void FixpointSSI::buildDefUseGraph(Function *F){
+  // Sigma dependencies as pairs of indexes sorted by variable.
+  std::vector<std::pair<unsigned,unsigned> > SigmaDeps;
+  for (SigmaUsersTy::iterator It = TrackedValuesUsedSigmaNode.begin(),
+	 E = TrackedValuesUsedSigmaNode.end(); It != E; ++It){
+    Instruction *V = dyn_cast<Instruction>(It->first);
+    Instruction *S = dyn_cast<Instruction>(It->second);
+    unsigned VIdx, SIdx;
+    if (V && S && 
+	InstWorkList.lookupIndex(V, VIdx) && InstWorkList.lookupIndex(S, SIdx))
+      SigmaDeps.push_back(std::make_pair(VIdx, SIdx));
+  }
+  std::sort(SigmaDeps.begin(), SigmaDeps.end());
+  TrackedValuesUsedSigmaNode.clear();
+
+  unsigned NextDep = 0;
+  for (unsigned N = 0, NE = InstWorkList.getNumElements(); N < NE; N++){
+    DefUse.addNode();
+    Instruction *I = InstWorkList.getElement(N);
+    for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
+	 UI != E; ++UI) {
+      Instruction *U = cast<Instruction>(*UI);
+      unsigned UIdx;
+      if (U == I || !InstWorkList.lookupIndex(U, UIdx)) continue;
+#ifdef SKIP_TRAP_BLOCKS
+      if (TrackedTrapBlocks.count(U->getParent())) continue;
+#endif 
+      DefUse.addUser(UIdx);
+    }
+    for (; NextDep < SigmaDeps.size() && SigmaDeps[NextDep].first == N; NextDep++)
+      DefUse.addUser(SigmaDeps[NextDep].second);
+  }
+  DefUse.finish();
+  NumOfDefUseEdges += DefUse.getNumEdges();
+  DEBUG(dbgs() << "Def-use graph of " << F->getName() << ": " 
+	<< DefUse.getNumNodes() << " nodes and " 
+	<< DefUse.getNumEdges() << " edges\n");
+}
 
 ///////////////////////////////////////////////////////////////////////////
 // Printing utililties
 ///////////////////////////////////////////////////////////////////////////
 
 // Helper to make easier the printing of results and stats.
-void sortByBasicBlock(Function *F, AbstractStateTy ValMap, 
+void sortByBasicBlock(Function *F, const AbstractState &ValMap, 
 		      DenseMap<BasicBlock*, std::set<AbstractValue*> * > & BlockMap){
 
-  for (AbstractStateTy::iterator I=ValMap.begin(), E=ValMap.end(); I != E; ++I){    
-    AbstractValue * AbsVal = I->second;
+  for (unsigned i=0, e=ValMap.size(); i < e; i++){    
+    AbstractValue * AbsVal = ValMap.get(i);
     if (!AbsVal) continue; // I think this should not happen!
     BasicBlock * BB = AbsVal->getBasicBlock();
     if (!BB) continue;
@@ -1904,7 +2203,7 @@ void FixpointSSI::printResultsGlobals(raw_ostream &Out){
   // Iterate over all global variables of interest defined in the module
   for (Module::global_iterator Gv = M->global_begin(), E = M->global_end(); Gv != E; ++Gv){
     if (TrackedGlobals.count(Gv)){
-      ValueState[Gv]->print(Out);
+      ValueState.lookup(Gv)->print(Out);
       Out << "\n";
     }
   }
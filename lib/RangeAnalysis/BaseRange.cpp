@@ -15,21 +15,6 @@ using namespace unimelb;
 
 // #define BITWISE_OP_DEBUG
 
-/// Return true is the range is top.
-bool BaseRange::IsTop() const{  
-  if (isConstant())  return false;
-  return __isTop;
-
-  // if (isSigned){
-  //   return (getLB() == APInt::getSignedMinValue(width) &&
-  // 	    getUB() == APInt::getSignedMaxValue(width));
-  // }
-  // else{
-  //   return (getLB() == APInt::getMinValue(width) &&
-  // 	    getUB() == APInt::getMaxValue(width)) ;
-  // }
-}
-
 
 /// Make a range top.
 void BaseRange::makeTop(){
@@ -121,37 +106,30 @@ checkOpWithShift(BaseRange * Op, BaseRange * Shift){
 /// following bits to 0's. If that value is less or equal than the
 /// corresponding upper bound (if we change a then we compare with c,
 /// otherwise we compare with d) we are done. Otherwise, we continue.
-int64_t minOr_int64t(int64_t a, int64_t b, int64_t c, int64_t d){
-  int64_t m, temp;  
-  m = 0x80000000;
-  while (m != 0) {
-    if (~a & c & m) {
-      temp = (a | m) & -m;
-      if (temp <= b) {
+APInt unimelb::
+minOr(const APInt &a_, const APInt &b, const APInt &c_, const APInt &d){
+  APInt a(a_), c(c_);
+  APInt m =   APInt::getOneBitSet(a.getBitWidth(), a.getBitWidth()-1);
+  while (m != 0){
+    if ((~a & c & m).getBoolValue()){
+      APInt temp = (a | m) & ~(m - 1);
+      if (temp.ule(b)){
 	a = temp;
 	break;
       }
     }
-    else if (a & ~c & m) {
-      temp = (c | m) & -m;
-      if (temp <= d) {
+    else if ((a & ~c & m).getBoolValue()){
+      APInt temp = (c | m) & ~(m - 1);
+      if (temp.ule(d)){
 	c = temp;
 	break;
       }
     }
-    m = m >> 1;
+    m = m.lshr(1);
   }
   return a | c;
 }
 
-APInt unimelb::
-minOr(const APInt &a, const APInt &b, const APInt &c, const APInt &d){
-  APInt res(a.getBitWidth(), 
-	    minOr_int64t(a.getSExtValue(), b.getSExtValue(), 
-			 c.getSExtValue(), d.getSExtValue()));
-  return res;
-}
-
 /// x=[a,b] and y=[c,d] Increase the value of x | y by decreasing the
 /// value of b or d We scan b and d from left to right. If both are
 /// 1's then change one to 0 and replace the subsequent bits to
@@ -159,36 +137,28 @@ minOr(const APInt &a, const APInt &b, const APInt &c, const APInt &d){
 /// lower bound we are done and the result is b | d. If the change
 /// cannot be done we try with the other. If not yet, we continue with
 /// the scan.
-int64_t maxOr_int64t(int64_t a, int64_t b, int64_t c, int64_t d){
-  int64_t m, temp;
-  
-  m = 0x80000000;
-  while (m != 0) {
-    if (b & d & m) {
-      temp = (b - m) | (m - 1);
-      if (temp >= a) {
+APInt unimelb::
+maxOr(const APInt &a, const APInt &b_, const APInt &c, const APInt &d_){
+  APInt b(b_), d(d_);
+  APInt m =   APInt::getOneBitSet(a.getBitWidth(), a.getBitWidth()-1);
+  while (m != 0){
+    if ((b & d & m).getBoolValue()){
+      APInt temp = (b - m) | (m - 1);
+      if (temp.uge(a)){
 	b = temp;
 	break;
       }
       temp = (d - m) | (m - 1);
-      if (temp >= c) {
+      if (temp.uge(c)){
 	d = temp;
 	break;
       }
     }
-    m = m >> 1;
+    m = m.lshr(1);
   }
   return b | d;
 }
 
-APInt unimelb::
-maxOr(const APInt &a, const APInt &b, const APInt &c, const APInt &d){
-  APInt res(a.getBitWidth(), 
-	    maxOr_int64t(a.getSExtValue(), b.getSExtValue(), 
-			 c.getSExtValue(), d.getSExtValue()));
-  return res;
-}
-
 /// x=[a,b] and y=[c,d] Reduce the value of x & y by increasing the
 /// value of a or c and We scan a and c from left to right. If both
 /// are 0's then change one to 1 and all subsequent bits to 0. If this
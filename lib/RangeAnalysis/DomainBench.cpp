@@ -0,0 +1,594 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file DomainBench.cpp
+///       Microbenchmark of the operations of the range domains.
+///
+/// The pass -domain-bench measures in isolation the lattice
+/// operations and the transfer functions of Range and WrappedRange
+/// so that changes to the domains can be evaluated without timing a
+/// whole analysis. The module given to opt is not analyzed: the pass
+/// only borrows its context to build a scratch function whose
+/// arguments are the variables of the abstract values.
+///
+/// The inputs of each operation are drawn from a pool of random
+/// intervals of the same width (1, 8, 16, 32 and 64 bits) built from
+/// a seeded generator so two runs with the same seed measure exactly
+/// the same operations. The pool mixes singletons, small and large
+/// intervals, wrapped intervals and top. Range cannot represent
+/// wrapped intervals so it gets intervals that cross zero instead.
+///
+/// For each domain, width and operation the pass prints a CSV line
+/// with the average time and the average number of allocations per
+/// operation. Only the objects served by the arena (abstract values
+/// and Boolean flags) are counted. APInt never allocates since all
+/// the widths are at most 64. The operations are called through the
+/// vtable as the generic solver does.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Range.h"
+#include "WrappedRange.h"
+#include "Support/Arena.h"
+#include "Support/Utils.h"
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/BasicBlock.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instructions.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace llvm;
+using namespace unimelb;
+
+cl::opt<unsigned>
+benchIterations("domain-bench-iters",
+		cl::init(100000),
+		cl::Hidden,
+		//!< User option to choose the length of each measurement.
+		cl::desc("Executions of each operation measured by -domain-bench"));
+
+cl::opt<unsigned>
+benchSeed("domain-bench-seed",
+	  cl::init(1),
+	  cl::Hidden,
+	  //!< User option to choose the inputs of the benchmark.
+	  cl::desc("Seed of the random intervals of -domain-bench"));
+
+cl::opt<std::string>
+benchOutput("domain-bench-output",
+	    cl::init(""),
+	    cl::Hidden,
+	    //!< User option to write the results into a file.
+	    cl::desc("CSV file with the results of -domain-bench (default: stderr)"),
+	    cl::value_desc("file"));
+
+namespace {
+
+  const unsigned NumWidths = 5;
+  const unsigned Widths[NumWidths] = { 1, 8, 16, 32, 64 };
+
+  /// Xorshift generator: the same sequence on every host.
+  class RandomGen{
+  public:
+    RandomGen(uint64_t Seed): State(Seed ? Seed : 88172645463325252ULL){}
+    inline uint64_t next(){
+      State ^= State << 13;
+      State ^= State >> 7;
+      State ^= State << 17;
+      return State;
+    }
+  private:
+    uint64_t State;
+  };
+
+  /// Scratch function with one argument of each width and cast
+  /// instructions between any two widths.
+  class BenchFunction{
+  public:
+    BenchFunction(LLVMContext &Ctx): M("domain-bench", Ctx){
+      std::vector<Type*> Params;
+      for (unsigned i=0; i < NumWidths; i++)
+	Params.push_back(IntegerType::get(Ctx, Widths[i]));
+      F = Function::Create(FunctionType::get(Type::getVoidTy(Ctx), Params, false),
+			   GlobalValue::InternalLinkage, "bench", &M);
+      BasicBlock *BB = BasicBlock::Create(Ctx, "entry", F);
+      Function::arg_iterator A = F->arg_begin();
+      for (unsigned i=0; i < NumWidths; i++, ++A)
+	Args[i] = &*A;
+      for (unsigned i=0; i < NumWidths; i++){
+	for (unsigned j=0; j < NumWidths; j++){
+	  Type *DestTy = Params[j];
+	  if (i > j){
+	    Casts[i][j][0] = CastInst::Create(Instruction::Trunc, Args[i], DestTy,
+					      "trunc", BB);
+	    Casts[i][j][1] = NULL;
+	  }
+	  else if (i < j){
+	    Casts[i][j][0] = CastInst::Create(Instruction::ZExt, Args[i], DestTy,
+					      "zext", BB);
+	    Casts[i][j][1] = CastInst::Create(Instruction::SExt, Args[i], DestTy,
+					      "sext", BB);
+	  }
+	  else
+	    Casts[i][j][0] = Casts[i][j][1] = NULL;
+	}
+      }
+      ReturnInst::Create(Ctx, BB);
+    }
+
+    Module M;
+    Function *F;
+    Value *Args[NumWidths];
+    /// Casts[i][j] from width i to width j: trunc or zext/sext.
+    Instruction *Casts[NumWidths][NumWidths][2];
+  };
+
+  /// Kinds of random intervals.
+  enum IntervalKindTy { SINGLETON, SMALL, LARGE, WRAPPED, TOP, NUM_KINDS };
+
+  template<typename D> D * newValue(Value *V);
+  template<> inline Range * newValue<Range>(Value *V){
+    return new Range(V, true);
+  }
+  template<> inline WrappedRange * newValue<WrappedRange>(Value *V){
+    return new WrappedRange(V);
+  }
+
+  /// The bounds of WrappedRange can wrap around, the signed bounds
+  /// of Range cannot.
+  template<typename D> bool canWrap();
+  template<> inline bool canWrap<Range>(){ return false; }
+  template<> inline bool canWrap<WrappedRange>(){ return true; }
+
+  /// Stopwatch and allocation counter for one line of the report.
+  class Measurement{
+  public:
+    Measurement(Arena &A): A(A), Allocs(A.getNumAllocations()),
+			   Start(TimeRecord::getCurrentTime(true).getWallTime()){}
+    void report(raw_ostream &Out, const char *Domain, unsigned Width,
+		const std::string &Op, unsigned N){
+      double Secs = TimeRecord::getCurrentTime(false).getWallTime() - Start;
+      if (N == 0) return;
+      Out << Domain << "," << Width << "," << Op << "," << N << ","
+	  << format("%.2f", Secs * 1e9 / N) << ","
+	  << format("%.3f", (double) (A.getNumAllocations() - Allocs) / N) << "\n";
+    }
+  private:
+    Arena &A;
+    unsigned Allocs;
+    double Start;
+  };
+
+  /// Benchmark of the domain D.
+  template<typename D>
+  class DomainBenchmark{
+  public:
+    DomainBenchmark(const char *Name, BenchFunction &BF, unsigned Iters,
+		    uint64_t Seed, raw_ostream &Out):
+      Name(Name), BF(BF), Iters(Iters), Rand(Seed), Out(Out){}
+
+    ~DomainBenchmark(){
+      // Values must go before the arenas that own them.
+      for (unsigned i=0; i < NumWidths; i++){
+	DeleteContainerPointers(Pools[i]);
+	DeleteContainerPointers(Shifts[i]);
+	DeleteContainerPointers(Olds[i]);
+	DeleteContainerPointers(News[i]);
+	DeleteContainerPointers(Filters[i]);
+	delete Current[i];
+      }
+    }
+
+    void run(){
+      {
+	Arena::Scope S(InputArena);
+	makeLandmarks();
+	for (unsigned i=0; i < NumWidths; i++)
+	  makeInputs(i);
+	for (unsigned i=0; i < IndexSize; i++)
+	  Index[i] = Rand.next() % PoolSize;
+      }
+
+      Arena::Scope S(OpArena);
+      for (unsigned i=0; i < NumWidths; i++){
+	benchAssign(i);
+	benchJoin(i);
+	benchGeneralizedJoin(i);
+	benchMeet(i);
+	benchLessOrEqual(i);
+	benchWidening(i);
+	for (unsigned p=0; p < NumPreds; p++)
+	  benchFilterSigma(i, Preds[p]);
+	for (unsigned o=0; o < NumArithOps; o++){
+	  benchArith(i, ArithOps[o], false);
+	  benchArith(i, ArithOps[o], true);
+	}
+	for (unsigned o=0; o < NumBitwiseOps; o++){
+	  benchBitwise(i, BitwiseOps[o], false);
+	  benchBitwise(i, BitwiseOps[o], true);
+	}
+	for (unsigned j=0; j < NumWidths; j++){
+	  for (unsigned k=0; k < 2; k++){
+	    if (!BF.Casts[i][j][k]) continue;
+	    benchCast(i, *BF.Casts[i][j][k], false);
+	    benchCast(i, *BF.Casts[i][j][k], true);
+	  }
+	}
+	// Everything allocated by the operations of this width is dead.
+	OpArena.Reset();
+      }
+    }
+
+  private:
+    static const unsigned PoolSize  = 256;  // power of 2
+    static const unsigned IndexSize = 4096; // power of 2
+    static const unsigned GeneralizedJoinArity = 4;
+    static const unsigned NumPreds = 6;
+    static const unsigned Preds[NumPreds];
+    static const unsigned NumArithOps = 7;
+    static const unsigned ArithOps[NumArithOps];
+    static const unsigned NumBitwiseOps = 6;
+    static const unsigned BitwiseOps[NumBitwiseOps];
+
+    const char *Name;
+    BenchFunction &BF;
+    unsigned Iters;
+    RandomGen Rand;
+    raw_ostream &Out;
+    Arena InputArena, OpArena;
+
+    /// Random intervals of each width.
+    std::vector<D*> Pools[NumWidths];
+    /// Shift amounts of each width: they must be smaller than the
+    /// width to be meaningful.
+    std::vector<D*> Shifts[NumWidths];
+    /// Pairs of intervals for widening: Olds[i][k] is strictly
+    /// included in News[i][k].
+    std::vector<D*> Olds[NumWidths], News[NumWidths];
+    /// Second operands of the filters: neither top nor bottom.
+    std::vector<D*> Filters[NumWidths];
+    /// Value of the variable that is being computed (top).
+    D* Current[NumWidths];
+    /// Sorted landmarks for the widening.
+    std::vector<int64_t> Landmarks;
+    /// Random indexes into the pools for the second operand.
+    unsigned Index[IndexSize];
+
+    inline D * first(unsigned W, unsigned i) {
+      return Pools[W][i & (PoolSize - 1)];
+    }
+    inline D * second(unsigned W, unsigned i) {
+      return Pools[W][Index[i & (IndexSize - 1)]];
+    }
+
+    /// Return a random interval of the given kind.
+    D * makeInterval(unsigned W, IntervalKindTy Kind){
+      unsigned Width = Widths[W];
+      D *V = newValue<D>(BF.Args[W]);
+      if (Kind == TOP) return V;
+      APInt Lo(Width, Rand.next()), Hi(Width, 0);
+      switch (Kind){
+      case SINGLETON:
+	Hi = Lo;
+	break;
+      case SMALL:
+	Hi = Lo + APInt(Width, Rand.next() % 16);
+	if (!canWrap<D>() && Hi.slt(Lo)){
+	  Hi = Lo;
+	  Lo = Lo - APInt(Width, Rand.next() % 16);
+	}
+	break;
+      case LARGE:
+	Hi = APInt(Width, Rand.next());
+	if (canWrap<D>() ? Hi.ult(Lo) : Hi.slt(Lo)) std::swap(Lo, Hi);
+	break;
+      case WRAPPED:
+	Hi = APInt(Width, Rand.next());
+	if (canWrap<D>()){
+	  if (Lo.ult(Hi)) std::swap(Lo, Hi);
+	}
+	else{
+	  // Cross zero instead.
+	  Lo.setBit(Width - 1);
+	  Hi.clearBit(Width - 1);
+	}
+	break;
+      default:
+	llvm_unreachable("Unexpected kind of interval");
+      }
+      // Intervals that cover everything must be represented by top.
+      bool IsFull = (canWrap<D>() ?
+		     (Hi + 1 == Lo) :
+		     (Lo.isMinSignedValue() && Hi.isMaxSignedValue()));
+      if (!IsFull){
+	V->setLB(Lo);
+	V->setUB(Hi);
+	V->resetTopFlag();
+      }
+      return V;
+    }
+
+    void makeInputs(unsigned W){
+      unsigned Width = Widths[W];
+      for (unsigned i=0; i < PoolSize; i++)
+	Pools[W].push_back(makeInterval(W, (IntervalKindTy) (i % NUM_KINDS)));
+
+      for (unsigned i=0; i < PoolSize; i++){
+	D *V = newValue<D>(BF.Args[W]);
+	if (i % NUM_KINDS != TOP){
+	  uint64_t K = Rand.next() % Width;
+	  V->setLB(APInt(Width, K));
+	  V->setUB(APInt(Width, (i % 2 ? K : std::min<uint64_t>(K + 2, Width - 1))));
+	  V->resetTopFlag();
+	}
+	Shifts[W].push_back(V);
+      }
+
+      for (unsigned i=0; i < PoolSize; i++){
+	D *Old = first(W, i);
+	D *New = static_cast<D*>(Old->clone());
+	New->join(Pools[W][Rand.next() % PoolSize]);
+	if (Old->isBot() || New->IsTop() || New->isEqual(Old)){
+	  delete New;
+	  continue;
+	}
+	Olds[W].push_back(static_cast<D*>(Old->clone()));
+	News[W].push_back(New);
+      }
+
+      for (unsigned i=0; i < PoolSize; i++){
+	D *V = first(W, i);
+	if (!V->IsTop() && !V->isBot())
+	  Filters[W].push_back(static_cast<D*>(V->clone()));
+      }
+
+      Current[W] = newValue<D>(BF.Args[W]);
+    }
+
+    /// The same landmarks the solver would collect from a program
+    /// with some small constants.
+    void makeLandmarks(){
+      std::set<int64_t> Set;
+      Utilities::recordLimitConstants(Set);
+      for (unsigned i=0; i < 32; i++){
+	int64_t C = (int64_t) (Rand.next() % 2001) - 1000;
+	Set.insert(C - 1);
+	Set.insert(C);
+	Set.insert(C + 1);
+      }
+      Landmarks.assign(Set.begin(), Set.end());
+      if (canWrap<D>())
+	std::sort(Landmarks.begin(), Landmarks.end(), Utilities::Lex_LessThan_Comp);
+    }
+
+    void benchAssign(unsigned W){
+      // Most operations below start by copying an input into the
+      // result so this is their baseline.
+      D Res(*Current[W]);
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++)
+	Res = *first(W, i);
+      M.report(Out, Name, Widths[W], "assign", Iters);
+    }
+
+    void benchJoin(unsigned W){
+      D Res(*Current[W]);
+      AbstractValue *R = &Res;
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	Res = *first(W, i);
+	R->join(second(W, i));
+      }
+      M.report(Out, Name, Widths[W], "join", Iters);
+    }
+
+    void benchGeneralizedJoin(unsigned W){
+      D Res(*Current[W]);
+      AbstractValue *R = &Res;
+      std::vector<AbstractValue*> Vs(GeneralizedJoinArity);
+      bool IsLattice = R->isLattice();
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	for (unsigned k=0; k < GeneralizedJoinArity; k++)
+	  Vs[k] = second(W, i * GeneralizedJoinArity + k);
+	Res = *Current[W];
+	R->makeBot();
+	if (IsLattice){
+	  // The solver joins the values one by one.
+	  for (unsigned k=0; k < GeneralizedJoinArity; k++)
+	    R->join(Vs[k]);
+	}
+	else
+	  R->GeneralizedJoin(Vs);
+      }
+      M.report(Out, Name, Widths[W], "GeneralizedJoin", Iters);
+    }
+
+    void benchMeet(unsigned W){
+      D Res(*Current[W]);
+      AbstractValue *R = &Res;
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	Res = *Current[W];
+	R->meet(first(W, i), second(W, i));
+      }
+      M.report(Out, Name, Widths[W], "meet", Iters);
+    }
+
+    void benchLessOrEqual(unsigned W){
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++)
+	first(W, i)->lessOrEqual(second(W, i));
+      M.report(Out, Name, Widths[W], "lessOrEqual", Iters);
+    }
+
+    void benchWidening(unsigned W){
+      unsigned N = Olds[W].size();
+      if (N == 0) return;
+      D Res(*Current[W]);
+      AbstractValue *R = &Res;
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	unsigned k = i % N;
+	Res = *News[W][k];
+	R->widening(Olds[W][k], Landmarks);
+      }
+      M.report(Out, Name, Widths[W], "widening", Iters);
+    }
+
+    void benchFilterSigma(unsigned W, unsigned Pred){
+      unsigned N = Filters[W].size();
+      if (N == 0) return;
+      D Res(*Current[W]);
+      AbstractValue *R = &Res;
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	D *Op1 = first(W, i);
+	Res = *Op1;
+	R->filterSigma(Pred, Op1, Filters[W][Index[i & (IndexSize - 1)] % N]);
+      }
+      M.report(Out, Name, Widths[W],
+	       std::string("filterSigma.") + getPredName(Pred), Iters);
+    }
+
+    void benchArith(unsigned W, unsigned OpCode, bool InPlace){
+      const char *OpName = Instruction::getOpcodeName(OpCode);
+      D Res(*Current[W]);
+      AbstractValue *Cur = Current[W];
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	if (InPlace)
+	  Cur->visitArithBinaryOpInPlace(&Res, first(W, i), second(W, i),
+					 OpCode, OpName);
+	else
+	  delete Cur->visitArithBinaryOp(first(W, i), second(W, i),
+					 OpCode, OpName);
+      }
+      M.report(Out, Name, Widths[W],
+	       std::string(OpName) + (InPlace ? ".inplace" : ""), Iters);
+    }
+
+    void benchBitwise(unsigned W, unsigned OpCode, bool InPlace){
+      const char *OpName = Instruction::getOpcodeName(OpCode);
+      bool IsShift = Instruction::isShift(OpCode);
+      const Type *Ty = BF.Args[W]->getType();
+      D Res(*Current[W]);
+      AbstractValue *Cur = Current[W];
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	D *Op2 = (IsShift ? Shifts[W][Index[i & (IndexSize - 1)]] : second(W, i));
+	if (InPlace)
+	  Cur->visitBitwiseBinaryOpInPlace(&Res, first(W, i), Op2, Ty, Ty,
+					   OpCode, OpName);
+	else
+	  delete Cur->visitBitwiseBinaryOp(first(W, i), Op2, Ty, Ty,
+					   OpCode, OpName);
+      }
+      M.report(Out, Name, Widths[W],
+	       std::string(OpName) + (InPlace ? ".inplace" : ""), Iters);
+    }
+
+    void benchCast(unsigned W, Instruction &I, bool InPlace){
+      unsigned DestWidth = 0;
+      Utilities::getIntegerWidth(I.getType(), DestWidth);
+      // The result is a value of the destination width.
+      AbstractValue *Cur = newValue<D>(&I);
+      D Res(*cast<D>(Cur));
+      Measurement M(OpArena);
+      for (unsigned i=0; i < Iters; i++){
+	if (InPlace)
+	  Cur->visitCastInPlace(&Res, I, first(W, i), NULL, true);
+	else
+	  delete Cur->visitCast(I, first(W, i), NULL, true);
+      }
+      delete Cur;
+      std::string OpName;
+      raw_string_ostream OS(OpName);
+      OS << I.getOpcodeName() << ".i" << DestWidth << (InPlace ? ".inplace" : "");
+      M.report(Out, Name, Widths[W], OS.str(), Iters);
+    }
+
+    static const char * getPredName(unsigned Pred){
+      switch (Pred){
+      case ICmpInst::ICMP_EQ:  return "eq";
+      case ICmpInst::ICMP_NE:  return "ne";
+      case ICmpInst::ICMP_SLT: return "slt";
+      case ICmpInst::ICMP_SLE: return "sle";
+      case ICmpInst::ICMP_SGT: return "sgt";
+      case ICmpInst::ICMP_SGE: return "sge";
+      default: return "?";
+      }
+    }
+  };
+
+  template<typename D>
+  const unsigned DomainBenchmark<D>::Preds[DomainBenchmark<D>::NumPreds] = {
+    ICmpInst::ICMP_EQ, ICmpInst::ICMP_NE, ICmpInst::ICMP_SLT,
+    ICmpInst::ICMP_SLE, ICmpInst::ICMP_SGT, ICmpInst::ICMP_SGE };
+
+  template<typename D>
+  const unsigned DomainBenchmark<D>::ArithOps[DomainBenchmark<D>::NumArithOps] = {
+    Instruction::Add, Instruction::Sub, Instruction::Mul, Instruction::UDiv,
+    Instruction::SDiv, Instruction::URem, Instruction::SRem };
+
+  template<typename D>
+  const unsigned DomainBenchmark<D>::BitwiseOps[DomainBenchmark<D>::NumBitwiseOps] = {
+    Instruction::And, Instruction::Or, Instruction::Xor, Instruction::Shl,
+    Instruction::LShr, Instruction::AShr };
+
+  /// Pass that runs the benchmark of both domains.
+  class DomainBench: public ModulePass {
+  public:
+    static char ID;
+    DomainBench(): ModulePass(ID){}
+
+    virtual bool runOnModule(Module &M){
+      std::string ErrorInfo;
+      raw_ostream *Out = &errs();
+      raw_fd_ostream *File = NULL;
+      if (benchOutput != ""){
+	File = new raw_fd_ostream(benchOutput.c_str(), ErrorInfo);
+	if (!ErrorInfo.empty()){
+	  errs() << "Error: " << ErrorInfo << "\n";
+	  delete File;
+	  return false;
+	}
+	Out = File;
+      }
+
+      BenchFunction BF(M.getContext());
+      *Out << "domain,width,operation,iterations,ns/op,allocs/op\n";
+      {
+	DomainBenchmark<Range> B("Range", BF, benchIterations, benchSeed, *Out);
+	B.run();
+      }
+      {
+	DomainBenchmark<WrappedRange> B("WrappedRange", BF, benchIterations,
+					benchSeed, *Out);
+	B.run();
+      }
+      delete File;
+      return false;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage& AU) const {
+      AU.setPreservesAll();
+    }
+  };
+
+  char DomainBench::ID = 0;
+  static RegisterPass<DomainBench> DB("domain-bench",
+				      "Microbenchmark of the range domains",
+				      false, false);
+}
@@ -116,10 +116,6 @@ void Range::makeBot() {
 }  
 
 
-bool Range::IsTop() const  { 
-  return BaseRange::IsTop();
-}
-
 void Range::makeTop() { 
   BaseRange::makeTop();
 }
@@ -377,7 +373,9 @@ void widenOneInterval(Range * Rng, const std::vector<int64_t> &JumpSet,
     int64_t MIN = APInt::getSignedMinValue(width).getSExtValue();
     int64_t cand;
     ( (lb_It == JumpSet.begin())? cand = *lb_It : cand = *(lb_It - 1));
-    if (cand < MIN)
+    // cand is greater than the lower bound if there is no landmark
+    // below it.
+    if (cand < MIN || cand > Rng->getLB().getSExtValue())
       lb = APInt::getSignedMinValue(width);
     else{
       APInt LB_LandMark(Rng->getWidth(), cand, Rng->IsSigned());
@@ -866,10 +864,27 @@ void Range::filterSigma_TwoVars(unsigned Pred, Range *I1, Range *I2){
 AbstractValue* Range::
 visitArithBinaryOp(AbstractValue* V1, AbstractValue* V2,
 		   unsigned OpCode, const char * OpCodeName ){
-  
-  Range *Op1 = cast<Range>(V1);
-  Range *Op2 = cast<Range>(V2);
   Range *LHS = new Range(*this);
+  ArithBinaryOp(LHS, cast<Range>(V1), cast<Range>(V2), OpCode, OpCodeName);
+  return LHS;
+}
+
+/// Same as visitArithBinaryOp but the result is stored in Res.
+bool Range::
+visitArithBinaryOpInPlace(AbstractValue *Res, 
+			  AbstractValue* V1, AbstractValue* V2,
+			  unsigned OpCode, const char * OpCodeName ){
+  Range *LHS = cast<Range>(Res);
+  *LHS = *this;
+  ArithBinaryOp(LHS, cast<Range>(V1), cast<Range>(V2), OpCode, OpCodeName);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute an arithmetic operation and check for overflow. LHS must
+/// be a copy of this.
+void Range::
+ArithBinaryOp(Range *LHS, Range *Op1, Range *Op2,
+	      unsigned OpCode, const char * OpCodeName ){
 
   DEBUG(dbgs() << "\t[RESULT] " 
 	<< *Op1 << " " << OpCodeName << " " << *Op2 << " = ");
@@ -888,7 +903,6 @@ visitArithBinaryOp(AbstractValue* V1, AbstractValue* V2,
 #endif 
 
   DEBUG(dbgs()<< *LHS << "\n");   
-  return LHS;
 }
 
 /// Execute an arithmetic operation but the caller will deal with
@@ -1291,6 +1305,25 @@ void Range::DoRem(bool IsSignedOp,
 /// overflow. If overflow detected then top.
 AbstractValue * Range::
 visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
+  Range *LHS = new Range(*this);
+  Cast(LHS, I, V, TB, IsSigned);
+  return LHS;
+}
+
+/// Same as visitCast but the result is stored in Res.
+bool Range::
+visitCastInPlace(AbstractValue *Res, Instruction &I,  
+		 AbstractValue * V, TBool * TB, bool IsSigned){
+  Range *LHS = cast<Range>(Res);
+  *LHS = *this;
+  Cast(LHS, I, V, TB, IsSigned);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute a casting operation and check for overflow. LHS must be a
+/// copy of this.
+void Range::
+Cast(Range *LHS, Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
 
   Range *RHS = NULL;    
   if (!V){
@@ -1304,7 +1337,6 @@ visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
     assert(!TB && "ERROR: some inconsistency found in visitCast");
   }
 
-  Range *LHS = new Range(*this);
   bool IsOverflow;
   DoCast(LHS,RHS,I.getOperand(0)->getType(),I.getType(),I.getOpcode(),IsOverflow);
 
@@ -1319,8 +1351,6 @@ visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
   DEBUG(dbgs() << "\t[RESULT]");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");      
-  return LHS;
-
 }
 
 /// Return true iff overflow during the truncate
@@ -1465,9 +1495,31 @@ AbstractValue * Range::
   visitBitwiseBinaryOp(AbstractValue * V1, AbstractValue * V2, 
 		       const Type * Op1Ty, const Type * Op2Ty, 
 		       unsigned OpCode,const char * OpCodeName){
-  Range *Op1 = cast<Range>(V1);
-  Range *Op2 = cast<Range>(V2);
   Range *LHS = new Range(*this);
+  BitwiseBinaryOp(LHS, cast<Range>(V1), cast<Range>(V2), 
+		  Op1Ty, Op2Ty, OpCode, OpCodeName);
+  return LHS;
+}
+
+/// Same as visitBitwiseBinaryOp but the result is stored in Res.
+bool Range:: 
+  visitBitwiseBinaryOpInPlace(AbstractValue *Res, 
+			      AbstractValue * V1, AbstractValue * V2, 
+			      const Type * Op1Ty, const Type * Op2Ty, 
+			      unsigned OpCode,const char * OpCodeName){
+  Range *LHS = cast<Range>(Res);
+  *LHS = *this;
+  BitwiseBinaryOp(LHS, cast<Range>(V1), cast<Range>(V2), 
+		  Op1Ty, Op2Ty, OpCode, OpCodeName);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute a bitwise operation and check for overflow. LHS must be a
+/// copy of this.
+void Range:: 
+  BitwiseBinaryOp(Range *LHS, Range *Op1, Range *Op2,
+		  const Type * Op1Ty, const Type * Op2Ty, 
+		  unsigned OpCode,const char * OpCodeName){
   DEBUG(dbgs() << "\t[RESULT] ");
   DEBUG(Op1->printRange(dbgs())); 
   DEBUG(dbgs() << " " << OpCodeName << " ");
@@ -1488,7 +1540,6 @@ AbstractValue * Range::
 
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");        
-  return LHS;  
 }
 
 /// Perform bitwise operations.  
@@ -8,7 +8,13 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "FixpointSSI.h"
+#include "FixpointSSIDomain.h"
 #include "Transformations/vSSA.h"
+#include "Support/ParallelDriver.h"
+#include "Support/ResultsCache.h"
+#include "Support/ResultStore.h"
+#include "Support/TraceLog.h"
+#include "Support/TransferCosts.h"
 #include "Range.h"
 #include "WrappedRange.h"
 #include "llvm/Pass.h"
@@ -23,9 +29,12 @@
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Utils/UnifyFunctionExitNodes.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Threading.h"
 
 using namespace llvm;
 using namespace unimelb;
@@ -76,6 +85,142 @@ numFuncs("numfuncs",
        cl::Hidden,
        cl::desc("Number of functions to be analyzed (default = -1, all)")); 
 
+cl::opt<unsigned> 
+jobs("jobs", 
+     cl::init(1),
+     cl::Hidden,
+     //!< User option to analyze functions in parallel.
+     cl::desc("Number of threads used to analyze functions (default = 1)")); 
+
+cl::opt<string> 
+costReport("cost-report", 
+	   cl::Hidden,
+	   //!< User option to check the cost model used by -jobs.
+	   cl::desc("Write the estimated cost and the analysis time of each function to a file"), 
+	   cl::value_desc("filename"));
+
+cl::opt<unsigned> 
+transferCache("transfer-cache", 
+	      cl::init(0),
+	      cl::Hidden,
+	      //!< User option to memoize the transfer functions.
+	      cl::desc("Number of entries of the cache of wrapped transfer functions (default = 0, disabled)")); 
+
+cl::opt<string> 
+resultsCache("results-cache", 
+	     cl::Hidden,
+	     //!< User option to reuse the results of unchanged functions.
+	     cl::desc("Reuse the results of functions analyzed in previous runs stored in a file"), 
+	     cl::value_desc("filename"));
+
+cl::opt<string> 
+resultStore("result-store", 
+	    cl::Hidden,
+	    //!< User option to save the results in binary form.
+	    cl::desc("Write the intervals and the reachable blocks of each function to a file"), 
+	    cl::value_desc("filename"));
+
+cl::opt<unsigned> 
+budgetTime("budget-time", 
+	   cl::init(0),
+	   cl::Hidden,
+	   //!< User option to bound the analysis time of each function.
+	   cl::desc("Milliseconds per function before widening to top (default = 0, no limit)")); 
+
+cl::opt<unsigned> 
+budgetVisits("budget-visits", 
+	     cl::init(0),
+	     cl::Hidden,
+	     //!< User option to bound the executed instructions of each function.
+	     cl::desc("Executed instructions per function before widening to top (default = 0, no limit)")); 
+
+cl::opt<unsigned> 
+budgetWidenings("budget-widenings", 
+		cl::init(0),
+		cl::Hidden,
+		//!< User option to bound the widenings of each function.
+		cl::desc("Widenings per function before widening to top (default = 0, no limit)")); 
+
+cl::opt<string> 
+budgetReport("budget-report", 
+	     cl::Hidden,
+	     //!< User option to list the functions that exceeded their budget.
+	     cl::desc("Write the functions that exceeded their budget to a file"), 
+	     cl::value_desc("filename"));
+
+cl::opt<string> 
+profileReport("profile-report", 
+	      cl::Hidden,
+	      //!< User option to find where the analysis time goes.
+	      cl::desc("Write the time of each phase and the work done for each function to a file"), 
+	      cl::value_desc("filename"));
+
+enum ProfileFormatTy { PROFILE_CSV, PROFILE_JSON };
+
+cl::opt<ProfileFormatTy>
+profileFormat("profile-format",
+	      cl::init(PROFILE_CSV),
+	      cl::Hidden,
+	      //!< User option to choose the format of -profile-report.
+	      cl::desc("Format of the profile report (default = csv)"),
+	      cl::values(clEnumValN(PROFILE_CSV, "csv", 
+				    "One line per function"),
+			 clEnumValN(PROFILE_JSON, "json", 
+				    "Array with one object per function"),
+			 clEnumValEnd));
+
+cl::opt<string> 
+traceEvents("trace-events", 
+	    cl::Hidden,
+	    //!< User option to see where the wall time goes.
+	    cl::desc("Write a timeline of the transformations and of the analysis of each function in the trace event format (chrome://tracing)"), 
+	    cl::value_desc("filename"));
+
+cl::opt<string> 
+transferCostReport("transfer-costs", 
+		   cl::Hidden,
+		   //!< User option to find which transfer functions are worth optimizing.
+		   cl::desc("Write the number, time and percentiles of the visits of each opcode and width to a file"), 
+		   cl::value_desc("filename"));
+
+cl::opt<bool> 
+accelerateIVs("accelerate-ivs", 
+	      cl::init(false),
+	      cl::Hidden,
+	      //!< User option to compute induction variables in closed form.
+	      cl::desc("Start induction variables from their closed form rather than widening them (default = false)")); 
+
+cl::opt<bool> 
+loopLandmarks("loop-landmarks", 
+	      cl::init(false),
+	      cl::Hidden,
+	      //!< User option to widen with the constants of each loop.
+	      cl::desc("Widen with the constants of each loop rather than of the whole function (default = false)")); 
+
+cl::opt<IterationStrategyTy>
+iterationStrategy("iteration-strategy",
+		  cl::init(WORKLIST),
+		  cl::Hidden,
+		  //!< User option to choose how the fixpoint is computed.
+		  cl::desc("Fixpoint iteration strategy (default = worklist)"),
+		  cl::values(clEnumValN(WORKLIST, "worklist", 
+					"Worklist driven by def-use chains"),
+			     clEnumValN(WTO, "wto", 
+					"Recursive strategy over a weak topological order"),
+			     clEnumValEnd));
+
+cl::opt<NarrowingStrategyTy>
+narrowingStrategy("narrowing-strategy",
+		  cl::init(NARROWING_PASSES),
+		  cl::Hidden,
+		  //!< User option to choose how the fixpoint is narrowed.
+		  cl::desc("Narrowing strategy (default = passes)"),
+		  cl::values(clEnumValN(NARROWING_PASSES, "passes", 
+					"Fixed number of passes over all the blocks"),
+			     clEnumValN(NARROWING_WORKLIST, "worklist", 
+					"Worklist starting from the widened values"),
+			     clEnumValEnd));
+
 // For range analysis
 #define SIGNED_RANGE_ANALYSIS true
 // For verbose mode
@@ -89,10 +234,63 @@ numFuncs("numfuncs",
 
 namespace unimelb {
 
+  /// Return the timeline of this run (NULL if not requested). It is
+  /// shared by the transformations and the analysis.
+  TraceLog * getTraceLog(){
+    if (traceEvents == "") return NULL;
+    static TraceLog Log;
+    return &Log;
+  }
+
+  /// Write the timeline if requested.
+  void writeTraceLog(){
+    if (TraceLog *Log = getTraceLog()){
+      std::string ErrorInfo;
+      if (!Log->write(traceEvents, ErrorInfo))
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+    }
+  }
+
+  /// Pass that opens (if Begin is NULL) or closes (otherwise) the
+  /// span of the pass that runs between them in the timeline.
+  struct TraceMarkerPass : public ModulePass{
+    static char ID; //!< Pass identification, replacement for typeid    
+    TraceMarkerPass(TraceLog::Buffer *B, const char *Name, TraceMarkerPass *Begin): 
+      ModulePass(ID), B(B), Name(Name), Begin(Begin), Start(0) {}
+    virtual bool runOnModule(Module &M){
+      if (Begin)
+	B->span(Name, "pass", Begin->Start, TraceLog::now());
+      else
+	Start = TraceLog::now();
+      return false;
+    }
+    virtual void getAnalysisUsage(AnalysisUsage& AU) const {
+      AU.setPreservesAll();
+    }    
+    virtual const char *getPassName() const { return "Trace marker"; }
+    TraceLog::Buffer *B;
+    const char *Name;
+    TraceMarkerPass *Begin;
+    double Start;
+  };
+  char TraceMarkerPass::ID = 0;
+
   /// An utility function that adds a pass to the pass manager.
+  ///
+  /// If a timeline is requested the pass is surrounded by two
+  /// markers. They are module passes so the function passes do not
+  /// run anymore one function at a time but one pass at a time,
+  /// which does not change the result.
   inline void addPass(PassManager &PM, Pass *P) {
+    TraceMarkerPass *Begin = NULL;
+    if (TraceLog *Log = getTraceLog()){
+      Begin = new TraceMarkerPass(Log->getBuffer(0), P->getPassName(), NULL);
+      PM.add(Begin);
+    }
     // Add the pass to the pass manager...
     PM.add(P);  
+    if (Begin)
+      PM.add(new TraceMarkerPass(Begin->B, Begin->Name, Begin));
 #ifdef VERBOSE
     dbgs() << "[RangeAnalysis]: running pass " <<  P->getPassName() << "\n";
 #endif 
@@ -195,6 +393,9 @@ namespace unimelb {
     RangeTransformationPass() : ModulePass(ID) {}
     virtual bool runOnModule(Module &M){
 
+      TraceLog *Log = getTraceLog();
+      TraceLog::Span S(Log ? Log->getBuffer(0) : NULL, "range-transformations", 
+		       "pass");
       PassManager Passes;
       addTransformPasses(Passes);  
       Passes.run(M);
@@ -212,16 +413,58 @@ namespace unimelb {
 						  false, false);
 
 
+  /// Collect the interval of every named local value of F and the
+  /// reachability of its blocks for the result store. The abstract
+  /// values of A must be ranges (i.e., subclasses of BaseRange).
+  void collectResults(FixpointSSI &A, Function *F, uint32_t DomainFlags,
+		      ResultStore::FunctionResults &R){
+    R.Name = F->getName().str();
+    R.Values.clear();
+    R.Blocks.clear();
+    DenseMap<BasicBlock*, unsigned> BlockIdx;
+    for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B){
+      BlockIdx[B] = R.Blocks.size();
+      ResultStore::FunctionResults::BlockTy RB;
+      RB.Name        = B->getName().str();
+      RB.IsReachable = A.IsReachable(B);
+      R.Blocks.push_back(RB);
+    }
+    const AbstractState &S = A.getValMap();
+    for (unsigned i=0, e=S.size(); i < e; i++){
+      Value *V = S.getValue(i);
+      if (!V->hasName() || !(isa<Argument>(V) || isa<Instruction>(V))) 
+	continue;
+      BaseRange *AbsV = static_cast<BaseRange*>(S.get(i));
+      ResultStore::FunctionResults::ValueTy RV;
+      RV.Name  = V->getName().str();
+      RV.Block = (AbsV->getBasicBlock() ? BlockIdx.lookup(AbsV->getBasicBlock()) : 0);
+      RV.Width = AbsV->getWidth();
+      RV.Flags = DomainFlags;
+      if (AbsV->isBot()) RV.Flags |= ResultStore::IS_BOT;
+      if (AbsV->IsTop()) RV.Flags |= ResultStore::IS_TOP;
+      RV.LB    = AbsV->getLB().getZExtValue();
+      RV.UB    = AbsV->getUB().getZExtValue();
+      R.Values.push_back(RV);
+    }
+  }
+
   /// Classical fixed-width range analysis
-  class RangeAnalysis: public FixpointSSI {
+  class RangeAnalysis: public FixpointSSIDomain<Range> {
   private:
     bool IsSigned;
   public:
     RangeAnalysis(Module *M, 
 		  unsigned WL, unsigned NL, 
 		  AliasAnalysis *AA,  bool isSigned): 
-      FixpointSSI(M,WL,NL,AA,isSigned,LESS_THAN), 
+      FixpointSSIDomain<Range>(M,WL,NL,AA,isSigned,LESS_THAN), 
       IsSigned(isSigned){
+      setIterationStrategy(iterationStrategy);
+      setNarrowingStrategy(narrowingStrategy);
+      setBudget(budgetTime / 1000.0, budgetVisits, budgetWidenings);
+      setProfiling(profileReport != "");
+      setTransferCosts(transferCostReport != "");
+      setInductionAcceleration(accelerateIVs);
+      setLoopLandmarks(loopLandmarks);
     }
 
     // Methods that allows Fixpoint creates Range objects
@@ -245,16 +488,39 @@ namespace unimelb {
       RV->join(&RC);      
       return RV;
     }
+    virtual AbstractValue* initAbsValInterval(Value *V, const APInt &Lo, 
+					      const APInt &Hi){
+      if (!IsSigned && Lo.ugt(Hi)) return NULL;
+      Range * R = new Range(V,IsSigned);
+      R->setLB(Lo);
+      R->setUB(Hi);
+      R->resetTopFlag();
+      return R;
+    }
+
+    /// Collect the results of F for the result store.
+    void recordResults(Function *F, ResultStore::FunctionResults &R){
+      collectResults(*this, F, (IsSigned ? ResultStore::IS_SIGNED : 0), R);
+    }
   };
 
 
   /// Wrapped Interval Analysis
-  class WrappedRangeAnalysis: public FixpointSSI {
+  class WrappedRangeAnalysis: public FixpointSSIDomain<WrappedRange> {
   public:
     WrappedRangeAnalysis(Module *M, 
 			 unsigned WL, unsigned NL, 
 			 AliasAnalysis *AA): 
-      FixpointSSI(M,WL,NL,AA,LEX_LESS_THAN){}
+      FixpointSSIDomain<WrappedRange>(M,WL,NL,AA,LEX_LESS_THAN){
+      setIterationStrategy(iterationStrategy);
+      setNarrowingStrategy(narrowingStrategy);
+      setBudget(budgetTime / 1000.0, budgetVisits, budgetWidenings);
+      setProfiling(profileReport != "");
+      setTransferCosts(transferCostReport != "");
+      setInductionAcceleration(accelerateIVs);
+      setLoopLandmarks(loopLandmarks);
+      setTransferCacheSize(transferCache);
+    }
 
     // Methods that allows Fixpoint creates Range objects
     virtual AbstractValue* initAbsValBot(Value *V){
@@ -278,6 +544,21 @@ namespace unimelb {
       RV->join(&RC);      
       return RV;
     }
+    virtual AbstractValue* initAbsValInterval(Value *V, const APInt &Lo, 
+					      const APInt &Hi){
+      // Lo <= Hi as signed integers so the interval goes clockwise
+      // from Lo to Hi.
+      WrappedRange * R = new WrappedRange(V);
+      R->setLB(Lo);
+      R->setUB(Hi);
+      R->resetTopFlag();
+      return R;
+    }
+
+    /// Collect the results of F for the result store.
+    void recordResults(Function *F, ResultStore::FunctionResults &R){
+      collectResults(*this, F, ResultStore::IS_WRAPPED, R);
+    }
   };
 
 
@@ -304,19 +585,120 @@ namespace unimelb {
     AU.setPreservesAll(); // Does not transform code
   }    
 
+  /// Return the number of threads used to analyze functions. Debugging
+  /// output cannot be split by function so it forces one thread.
+  unsigned getNumOfJobs(){
+    unsigned N = (jobs == 0 ? 1 : (unsigned) jobs);
+    if (N == 1) return 1;
+#ifndef NDEBUG
+    if (DebugFlag){
+      dbgs() << "Warning: -debug is enabled so -jobs is ignored.\n";
+      return 1;
+    }
+#endif 
+    // Make STATISTIC counters and LLVM's lazily created constants
+    // safe to use from several threads.
+    if (!llvm_start_multithreaded()){
+      dbgs() << "Warning: LLVM was built without threads so -jobs is ignored.\n";
+      return 1;
+    }
+    return N;
+  }
+
+  /// Return the description of the analysis used by the results
+  /// cache. Everything that can change the results of a function
+  /// other than its code and the version of the analysis (see
+  /// ResultsCache::AnalysisVersion) must be here.
+  std::string getResultsCacheOptions(StringRef Domain){
+    std::string Options;
+    raw_string_ostream OS(Options);
+    OS << Domain 
+       << " widening=" << widening 
+       << " narrowing=" << narrowing
+       << " iteration-strategy=" << (iterationStrategy == WTO ? "wto" : "worklist")
+       << " narrowing-strategy=" 
+       << (narrowingStrategy == NARROWING_WORKLIST ? "worklist" : "passes")
+       << " budget-visits=" << budgetVisits
+       << " budget-widenings=" << budgetWidenings
+       << " accelerate-ivs=" << accelerateIVs
+       << " loop-landmarks=" << loopLandmarks;
+    return OS.str();
+  }
+
+  /// Write the profile of each function analyzed by Driver (see
+  /// FunctionProfile.h). Times are in seconds.
   template<typename Analysis>
-  void runAnalysis(Module &M, CallGraph *CG, Analysis a){
+  void writeProfileReport(raw_ostream &Out, const ParallelDriver<Analysis> &Driver,
+			  const std::vector<Function*> &Funcs){
+    if (profileFormat == PROFILE_CSV)
+      Out << "function,init (s),solve (s),narrowing (s),print (s),"
+	  << "inst visits,block visits,widenings,sigma revisits,"
+	  << "peak values,degraded\n";
+    else
+      Out << "[\n";
+    for (unsigned i=0; i < Funcs.size(); i++){
+      const FunctionProfile &P = Driver.getProfile(i);
+      const char *Degraded = SolverBudget::getName(P.Exceeded);
+      if (profileFormat == PROFILE_CSV){
+	Out << Funcs[i]->getName() << ","
+	    << format("%.6f", P.InitTime) << ","
+	    << format("%.6f", P.SolveTime) << ","
+	    << format("%.6f", P.NarrowingTime) << ","
+	    << format("%.6f", P.PrintTime) << ","
+	    << P.InstVisits << "," << P.BlockVisits << ","
+	    << P.Widenings << "," << P.SigmaRevisits << ","
+	    << P.PeakValues << "," << Degraded << "\n";
+	continue;
+      }
+      Out << "  {\"function\": ";
+      Utilities::writeJSONString(Out, Funcs[i]->getName());
+      Out << ", \"init\": "      << format("%.6f", P.InitTime)
+	  << ", \"solve\": "     << format("%.6f", P.SolveTime)
+	  << ", \"narrowing\": " << format("%.6f", P.NarrowingTime)
+	  << ", \"print\": "     << format("%.6f", P.PrintTime)
+	  << ", \"inst_visits\": "    << P.InstVisits
+	  << ", \"block_visits\": "   << P.BlockVisits
+	  << ", \"widenings\": "      << P.Widenings
+	  << ", \"sigma_revisits\": " << P.SigmaRevisits
+	  << ", \"peak_values\": "    << P.PeakValues
+	  << ", \"degraded\": \""     << Degraded << "\"}"
+	  << (i + 1 < Funcs.size() ? "," : "") << "\n";
+    }
+    if (profileFormat == PROFILE_JSON)
+      Out << "]\n";
+  }
+
+  /// Write the costs of the transfer functions of all the workers
+  /// if requested.
+  template<typename Analysis>
+  void writeTransferCosts(const std::vector<Analysis*> &Workers){
+    if (transferCostReport == "") return;
+    TransferCosts Total;
+    for (unsigned i=0; i < Workers.size(); i++)
+      Total.merge(Workers[i]->getTransferCosts());
+    std::string ErrorInfo;
+    raw_fd_ostream Out(transferCostReport.c_str(), ErrorInfo);
+    if (!ErrorInfo.empty())
+      dbgs() << "ERROR: " << ErrorInfo << "\n";
+    else
+      Total.write(Out);
+  }
+
+  /// Analyze the functions of M. If there is more than one analysis
+  /// in Workers then the functions are analyzed in parallel, each
+  /// thread using its own analysis. Domain names the abstract domain
+  /// (see getResultsCacheOptions).
+  template<typename Analysis>
+  void runAnalysis(Module &M, CallGraph *CG, std::vector<Analysis*> &Workers,
+		   StringRef Domain){
+    std::vector<Function*> Funcs;
     if (runOnlyFunction != ""){
       Function *F = M.getFunction(runOnlyFunction); 
       if (!F){ 
 	dbgs() << "ERROR: function " << runOnlyFunction << " not found\n\n";
 	return;
       }
-      a.init(F);
-      a.solve(F);
-#ifdef  PRINT_RESULTS 	  
-      a.printResultsFunction(F,dbgs());
-#endif 
+      Funcs.push_back(F);
     }
       else{
 	int k=0;
@@ -324,18 +706,152 @@ namespace unimelb {
 	  if (IsAnalyzable(F,*CG)){
 	    if ( (numFuncs > 0) && (k > numFuncs)) 
 	      break;
+	    Funcs.push_back(F);
+	    k++;
+	  }
+	}
+      }
 
-	    DEBUG(dbgs() << "------------------------------------------------------------------------\n");
-	    a.init(F);
-	    a.solve(F);
 #ifdef  PRINT_RESULTS 	  
-	    //a.printResultsGlobals(dbgs());
-	    a.printResultsFunction(F,dbgs());
+    bool PrintResults = true;
+#else
+    bool PrintResults = false;
 #endif 
-	    k++;
-	  }
+
+    if (Workers.size() == 1 && costReport == "" && resultsCache == "" &&
+	resultStore == "" && budgetReport == "" && profileReport == "" &&
+	traceEvents == ""){
+      Analysis &a = *Workers[0];
+      for (unsigned i=0; i < Funcs.size(); i++){
+	Function *F = Funcs[i];
+	DEBUG(dbgs() << "------------------------------------------------------------------------\n");
+	a.init(F);
+	a.solve(F);
+	//a.printResultsGlobals(dbgs());
+	if (PrintResults) a.printResultsFunction(F,dbgs());
+      }
+      return;
+    }
+
+    // These constants are created lazily by LLVM the first time they
+    // are requested. Do it now before the threads race for them. The
+    // i32 zero is created by Utilities::addTrackedIntegerConstants.
+    ConstantInt::getTrue(M.getContext());
+    ConstantInt::getFalse(M.getContext());
+    ConstantInt::get(Type::getInt32Ty(M.getContext()), 0, true);
+
+    // Functions whose results are in the cache are not analyzed. If
+    // a result store is written then they must also be in the
+    // previous one since their results are copied from there.
+    ResultStore::Reader OldStore;
+    bool HasOldStore = false;
+    if (resultStore != "" && resultsCache != ""){
+      std::string ErrorInfo;
+      HasOldStore = OldStore.open(resultStore, ErrorInfo);
+    }
+    ResultsCache Cache;
+    std::vector<uint64_t> Keys;
+    std::vector<std::string> CachedOutputs(Funcs.size());
+    std::vector<bool> IsCached(Funcs.size(), false);
+    if (resultsCache != ""){
+      std::string ErrorInfo;
+      if (!Cache.load(resultsCache, ErrorInfo))
+	dbgs() << "Warning: " << ErrorInfo << ". Analyzing all functions.\n";
+      std::string Options = getResultsCacheOptions(Domain);
+      for (unsigned i=0; i < Funcs.size(); i++){
+	Keys.push_back(ResultsCache::getKey(Funcs[i], Options));
+	IsCached[i] = 
+	  (resultStore == "" || 
+	   (HasOldStore && OldStore.lookupFunction(Funcs[i]->getName().str()))) &&
+	  Cache.lookup(Keys[i], Funcs[i]->getName(), CachedOutputs[i]);
+      }
+    }
+    std::vector<Function*> Todo;
+    for (unsigned i=0; i < Funcs.size(); i++)
+      if (!IsCached[i]) Todo.push_back(Funcs[i]);
+
+    std::vector<uint64_t> Costs;
+    for (unsigned i=0; i < Todo.size(); i++)
+      Costs.push_back(Utilities::estimateAnalysisCost(Todo[i]));
+
+    ParallelDriver<Analysis> Driver(Workers, Todo, PrintResults);
+    Driver.setCosts(Costs);
+    Driver.setRecordResults(resultStore != "");
+    Driver.setTrace(getTraceLog());
+    Driver.run();
+    ResultStore::Writer Store;
+    for (unsigned i=0, j=0; i < Funcs.size(); i++){
+      if (IsCached[i]){
+	dbgs() << CachedOutputs[i];
+	if (resultStore != ""){
+	  ResultStore::FunctionResults R;
+	  OldStore.getResults(*OldStore.lookupFunction(Funcs[i]->getName().str()), R);
+	  Store.add(R);
 	}
+	continue;
       }
+      dbgs() << Driver.getOutput(j);
+      // The results of a function that ran out of time depend on the
+      // load of the machine so they are not cached.
+      if (resultsCache != "" && 
+	  Driver.getBudget(j).getExceeded() != SolverBudget::TIME)
+	Cache.insert(Keys[i], Funcs[i]->getName(), Driver.getOutput(j));
+      if (resultStore != "")
+	Store.add(Driver.getResults(j));
+      j++;
+    }
+    if (resultStore != ""){
+      std::string ErrorInfo;
+      if (!Store.write(resultStore, ErrorInfo))
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+    }
+    if (resultsCache != ""){
+      std::string ErrorInfo;
+      if (!Cache.save(resultsCache, ErrorInfo))
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+    }
+
+    if (budgetReport != ""){
+      std::string ErrorInfo;
+      raw_fd_ostream Out(budgetReport.c_str(), ErrorInfo);
+      if (!ErrorInfo.empty())
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+      else{
+	Out << "function,exceeded,time (s),visits,widenings\n";
+	for (unsigned i=0; i < Todo.size(); i++){
+	  const SolverBudget &B = Driver.getBudget(i);
+	  if (!B.isExceeded()) continue;
+	  Out << Todo[i]->getName() << "," 
+	      << SolverBudget::getName(B.getExceeded()) << "," 
+	      << format("%.6f", B.getSeconds()) << "," 
+	      << B.getNumVisits() << "," << B.getNumWidenings() << "\n";
+	}
+      }
+    }
+
+    if (profileReport != ""){
+      std::string ErrorInfo;
+      raw_fd_ostream Out(profileReport.c_str(), ErrorInfo);
+      if (!ErrorInfo.empty())
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+      else
+	writeProfileReport(Out, Driver, Todo);
+    }
+
+    if (costReport != ""){
+      std::string ErrorInfo;
+      raw_fd_ostream Out(costReport.c_str(), ErrorInfo);
+      if (!ErrorInfo.empty()){
+	dbgs() << "ERROR: " << ErrorInfo << "\n";
+	return;
+      }
+      Out << "function,estimated cost,time (s),worker\n";
+      for (unsigned i=0; i < Todo.size(); i++){
+	Out << Todo[i]->getName() << "," << Costs[i] << "," 
+	    << format("%.6f", Driver.getTime(i)) << "," 
+	    << Driver.getWorker(i) << "\n";
+      }
+    }
   }
 
   /// To run an intraprocedural range analysis.
@@ -350,8 +866,18 @@ namespace unimelb {
       dbgs() <<"\n===-------------------------------------------------------------------------===\n" ;  
       dbgs() << "               Range Integer Variable Analysis \n";
       dbgs() <<"===-------------------------------------------------------------------------===\n" ;      
-      RangeAnalysis a(&M, widening , narrowing , AA, SIGNED_RANGE_ANALYSIS);
-      runAnalysis(M,CG,a);
+      std::vector<RangeAnalysis*> Workers;
+      for (unsigned i=0, e=getNumOfJobs(); i < e; i++)
+	Workers.push_back(new RangeAnalysis(&M, widening , narrowing , AA, 
+					    SIGNED_RANGE_ANALYSIS));
+      {
+	TraceLog *Log = getTraceLog();
+	TraceLog::Span S(Log ? Log->getBuffer(0) : NULL, "range-analysis", "pass");
+	runAnalysis(M,CG,Workers,"range");
+      }
+      writeTraceLog();
+      writeTransferCosts(Workers);
+      DeleteContainerPointers(Workers);
       return false;
     }
 
@@ -373,8 +899,17 @@ namespace unimelb {
       dbgs() <<"\n===-------------------------------------------------------------------------===\n";  
       dbgs() << "               Wrapped Range Integer Variable Analysis \n";
       dbgs() <<"===-------------------------------------------------------------------------===\n";      
-      WrappedRangeAnalysis a(&M, widening , narrowing , AA);
-      runAnalysis(M,CG,a);
+      std::vector<WrappedRangeAnalysis*> Workers;
+      for (unsigned i=0, e=getNumOfJobs(); i < e; i++)
+	Workers.push_back(new WrappedRangeAnalysis(&M, widening , narrowing , AA));
+      {
+	TraceLog *Log = getTraceLog();
+	TraceLog::Span S(Log ? Log->getBuffer(0) : NULL, "wrapped-range-analysis", "pass");
+	runAnalysis(M,CG,Workers,"wrapped-range");
+      }
+      writeTraceLog();
+      writeTransferCosts(Workers);
+      DeleteContainerPointers(Workers);
       return false;
     }
 
@@ -465,8 +1000,8 @@ namespace unimelb {
     unsigned NumOfTrivial;
     
     template<typename Analysis1, typename Analysis2>
-    void runAnalyses(Analysis1 a1, std::string a1_StrName,
-		     Analysis2 a2, std::string a2_StrName, Function *F){
+    void runAnalyses(Analysis1 &a1, std::string a1_StrName,
+		     Analysis2 &a2, std::string a2_StrName, Function *F){
 
 #ifdef  VERBOSE
 	dbgs() << "---------------- Function " << F->getName() << "---------------------\n";
@@ -492,18 +1027,15 @@ namespace unimelb {
 
       // We cannot assume a particular order of the entries since LLVM
       // can generate different orders
-      AbstractStateTy UnwrappedMap         = Unwrapped.getValMap();
-      AbstractStateTy WrappedMap  = Wrapped.getValMap();     
-      // This is expensive because is n*m where n,m sizes of the two
-      // hash tables. Most of the time, n is equal to m.
-      typedef AbstractStateTy::iterator It;
-      for (It B=UnwrappedMap.begin(), E=UnwrappedMap.end(); B != E; ++B){
-	if (!B->second){
+      const AbstractState &UnwrappedMap = Unwrapped.getValMap();
+      const AbstractState &WrappedMap   = Wrapped.getValMap();     
+      for (unsigned i=0, e=UnwrappedMap.size(); i < e; i++){
+	if (!UnwrappedMap.get(i)){
 	  continue;
 	}
-	if (Range * I1 = dyn_cast<Range>(B->second)){
+	if (Range * I1 = dyn_cast<Range>(UnwrappedMap.get(i))){
 	  if (I1 && (!I1->isConstant())){
-	    AbstractValue *AbsVal =WrappedMap[B->first];
+	    AbstractValue *AbsVal =WrappedMap.lookup(UnwrappedMap.getValue(i));
 	    assert(AbsVal);
 	    WrappedRange *I2 = dyn_cast<WrappedRange>(AbsVal);
 	    assert(I2);
@@ -56,19 +56,6 @@ void printComparisonOp(unsigned Pred,raw_ostream &Out){
   }
 }
 
-bool WrappedRange::isBot() const { 
-  return __isBottom;
-}
-
-bool WrappedRange::IsTop() const {  
-  return BaseRange::IsTop();
-}
-
-void WrappedRange::makeBot(){ 
-  __isBottom=true;
-  __isTop=false;
-}
-
 void WrappedRange::makeTop(){ 
   BaseRange::makeTop();
   __isBottom=false;
@@ -393,11 +380,114 @@ void WrappedRange::widening(AbstractValue *PreviousV,
   return;
 }
 
+////
+// Operations on the bounds of wrapped intervals that are neither
+// bottom nor top. They are parameterized by the representation of
+// the bounds: WrappedBound if the width fits into a machine word and
+// APInt otherwise.
+////
+
+/// Return true if e \in [x,y].
+template<typename Bound>
+inline bool BoundsMember(const Bound &e, const Bound &x, const Bound &y){
+  // e <=_{x} y iff e - x <= y - x
+  return Lex_LessOrEqual(e - x, y - x);
+}
+
+/// Return true if [a,b] is less or equal than [c,d] based on the
+/// poset ordering.
+template<typename Bound>
+inline bool BoundsLessOrEqual(const Bound &a, const Bound &b, 
+			      const Bound &c, const Bound &d){
+  // a \in T and b \in T and (c \in s and d \in s => s=t)
+  return ( BoundsMember(a,c,d) && BoundsMember(b,c,d) &&
+	   ((a == c && b == d) || 
+	    !BoundsMember(c,a,b) || !BoundsMember(d,a,b)));
+}
+
+/// Join of [a,b] and [c,d] if none of them contains the other. Return
+/// false if the result is top. Otherwise, the result is [lb,ub].
+template<typename Bound>
+bool BoundsJoin(const Bound &a, const Bound &b, const Bound &c, const Bound &d,
+		Bound &lb, Bound &ub){
+  // Extra case for top: one cover the other
+  if (BoundsMember(a,c,d) && BoundsMember(b,c,d) &&
+      BoundsMember(c,a,b) && BoundsMember(d,a,b)){
+#ifdef DEBUG_JOIN
+    dbgs() << "one cover the other case\n";
+#endif 
+    return false;
+  }
+  // Overlapping cases
+  if (BoundsMember(c,a,b)){
+#ifdef DEBUG_JOIN
+    dbgs() << "overlapping case\n";
+#endif 
+    lb = a; ub = d;
+  }
+  else if (BoundsMember(a,c,d)){
+#ifdef DEBUG_JOIN
+    dbgs() << "overlapping case\n";
+#endif 
+    lb = c; ub = b;
+  }
+  // Left/Right Leaning cases: non-deterministic cases
+  // Here we use lexicographical order to resolve ties
+  else if (WrappedRange::WCard(b,c) == WrappedRange::WCard(d,a)){
+    NumOfJoinTies++;
+    if (Lex_LessThan(a,c)){
+      // avoid crossing NP
+      lb = a; ub = d;
+    }
+    else{
+      // avoid crossing NP
+      lb = c; ub = b;
+    }
+  }
+  else if (Lex_LessOrEqual(WrappedRange::WCard(b,c), WrappedRange::WCard(d,a))){
+#ifdef DEBUG_JOIN
+    dbgs() << "\nnon-overlapping case (left)\n";
+    dbgs() << "Card(b,c)=" << WrappedRange::WCard(b,c).toString(10,false) << " "
+           << "Card(d,a)=" << WrappedRange::WCard(d,a).toString(10,false) << "\n";
+#endif 
+    lb = a; ub = d;
+  }
+  else{
+#ifdef DEBUG_JOIN
+    dbgs() << "\nnon-overlapping case (right)\n";
+    dbgs() << "Card(b,c)=" << WrappedRange::WCard(b,c).toString(10,false) << " " 
+           << "Card(d,a)=" << WrappedRange::WCard(d,a).toString(10,false) << "\n";
+#endif 
+    lb = c; ub = b;
+  }
+  return true;
+}
+
+/// Return true if the pole [p1,p2] is included in [x,y], i.e., if
+/// [x,y] must be split at that pole.
+inline bool CrossPole(const APInt &p1, const APInt &p2, 
+		      const APInt &x , const APInt &y){
+  if (WrappedBound::IsNative(x.getBitWidth()))
+    return BoundsLessOrEqual(WrappedBound(p1), WrappedBound(p2), 
+			     WrappedBound(x) , WrappedBound(y));
+  return BoundsLessOrEqual(p1, p2, x, y);
+}
+
+/// Return true if x \in [a,b]. 
+bool WrappedRange::WrappedMember(const WrappedBound &e) const{
+  if (isBot()) return false;
+  if (IsTop()) return true;
+  return BoundsMember(e, WrappedBound(LB), WrappedBound(UB));
+}
+
 /// Return true if x \in [a,b]. 
 bool WrappedRange::WrappedMember(const APInt &e) const{
   if (isBot()) return false;
   if (IsTop()) return true;
 
+  if (WrappedBound::IsNative(e.getBitWidth()))
+    return BoundsMember(WrappedBound(e), WrappedBound(LB), WrappedBound(UB));
+
   APInt x = getLB();
   APInt y = getUB();
 
@@ -437,18 +527,14 @@ bool WrappedRange::WrappedlessOrEqual(AbstractValue * V){
 	return true;
     }
   }
-  ///
-  // a \in T and b \in T and (c \in s and d \in s => s=t)
-  ///
-  APInt a = S->getLB();
-  APInt b = S->getUB();
-  APInt c = T->getLB();
-  APInt d = T->getUB();
-  
-  return ( T->WrappedMember(a) && 
-	   T->WrappedMember(b) &&
-	   (S->isIdentical(T) || 
-	    !(S->WrappedMember(c)) || !(S->WrappedMember(d))));	   	    
+  if (T->isBot()) return false;
+  // From here neither S nor T are bottom or top so only the bounds
+  // matter.
+  if (WrappedBound::IsNative(S->LB.getBitWidth()))
+    return BoundsLessOrEqual(WrappedBound(S->LB), WrappedBound(S->UB),
+			     WrappedBound(T->LB), WrappedBound(T->UB));
+
+  return BoundsLessOrEqual(S->LB, S->UB, T->LB, T->UB);
 }
 
 
@@ -469,15 +555,15 @@ void WrappedRange::join(AbstractValue *V){
     return;
   }
 #if 0
-  std::vector<WrappedRangePtr> s1 = 
-    WrappedRange::ssplit(R->getLB(), R->getUB(), R->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    WrappedRange::ssplit(getLB(), getUB(), getLB().getBitWidth());
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  WrappedRangeSplit s1;
+  WrappedRange::ssplit(R->getLB(), R->getUB(), R->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  WrappedRange::ssplit(getLB(), getUB(), getLB().getBitWidth(), s2);
+  typedef WrappedRangeSplit::iterator It;
   for (It I1=s1.begin(), E1=s1.end(); I1!=E1; ++I1){
     for (It I2=s2.begin(), E2=s2.end(); I2!=E2; ++I2){      
       // FIXME: use GeneralizedJoin to get more precise results.
-      this->Binary_WrappedJoin((*I1).get(), (*I2).get());
+      this->Binary_WrappedJoin(&*I1, &*I2);
     }
   }
 #else 
@@ -499,10 +585,6 @@ void WrappedRange::WrappedJoin(AbstractValue *V){
   WrappedRange *S = this;
   WrappedRange *T = cast<WrappedRange>(V);
 
-  APInt a = S->getLB();
-  APInt b = S->getUB();
-  APInt c = T->getLB();
-  APInt d = T->getUB();
 #ifdef DEBUG_JOIN
   dbgs() << " join( " ;
   S->printRange(dbgs()) ; 
@@ -524,93 +606,26 @@ void WrappedRange::WrappedJoin(AbstractValue *V){
 #endif 
     WrappedRangeAssign(T);
   }
-  // Extra case for top: one cover the other
-  else if (T->WrappedMember(a) && T->WrappedMember(b) &&
-           S->WrappedMember(c) && S->WrappedMember(d)){
-#ifdef DEBUG_JOIN
-    dbgs() << "one cover the other case\n";
-#endif 
-    makeTop();
-  }
-  // Overlapping cases
-  else if (S->WrappedMember(c)){
-#ifdef DEBUG_JOIN
-    dbgs() << "overlapping case\n";
-#endif 
-    setLB(a);
-    setUB(d);
-  }
-  else if (T->WrappedMember(a)){
-#ifdef DEBUG_JOIN
-    dbgs() << "overlapping case\n";
-#endif 
-    setLB(c);
-    setUB(b);
-  }
-  // Left/Right Leaning cases: non-deterministic cases
-  // Here we use lexicographical order to resolve ties
-  else if (WCard(b,c) == WCard(d,a)){
-    NumOfJoinTies++;
-    if (Lex_LessThan(a,c)){
-      // avoid crossing NP
-      setLB(a);
-      setUB(d);
-      // crossing NP
-      /*
-        setLB(c);
-        setUB(b);
-      */
+  else if (WrappedBound::IsNative(LB.getBitWidth())){
+    unsigned w = LB.getBitWidth();
+    WrappedBound lb(0,w), ub(0,w);
+    if (BoundsJoin(WrappedBound(S->LB), WrappedBound(S->UB), 
+		   WrappedBound(T->LB), WrappedBound(T->UB), lb, ub)){
+      setLB(lb.toAPInt());
+      setUB(ub.toAPInt());
     }
-    else{
-      // avoid crossing NP
-      setLB(c);
-      setUB(b);
-      // crossing NP
-      /*
-        setLB(a);
-        setUB(d);
-      */
-    }
-  }
-  else if (Lex_LessOrEqual(WCard(b,c), WCard(d,a))){
-#ifdef DEBUG_JOIN
-    dbgs() << "\nnon-overlapping case (left)\n";
-    dbgs() << "Card(b,c)=" << WCard(b,c).toString(10,false) << " "
-           << "Card(d,a)=" << WCard(d,a).toString(10,false) << "\n";
-#endif 
-    setLB(a);
-    setUB(d);
+    else
+      makeTop();
   }
   else{
-#ifdef DEBUG_JOIN
-    dbgs() << "\nnon-overlapping case (right)\n";
-    dbgs() << "Card(b,c)=" << WCard(b,c).toString(10,false) << " " 
-           << "Card(d,a)=" << WCard(d,a).toString(10,false) << "\n";
-#endif 
-    setLB(c);
-    setUB(b);
-  }
-
-
-//   else if ( Lex_LessOrEqual(WCard(b,c), WCard(d,a)) ||
-//             (WCard(b,c) == WCard(d,a) &&  Lex_LessThan(a,c))){
-// #ifdef DEBUG_JOIN
-//     dbgs() << "\nnon-overlapping case (left)\n";
-//     dbgs() << "Card(b,c)="  << WCard(b,c).toString(10,false) << " "
-//            << "Card(d,a)=" << WCard(d,a).toString(10,false)  << "\n";
-// #endif 
-//     setLB(a);
-//     setUB(d);
-//   }
-//   else{
-// #ifdef DEBUG_JOIN
-//     dbgs() << "\nnon-overlapping case (right)\n";
-//     dbgs() << "Card(b,c)="  << WCard(b,c).toString(10,false) << " " 
-//            << "Card(d,a)=" << WCard(d,a).toString(10,false)  << "\n";
-// #endif 
-//     setLB(c);
-//     setUB(b);
-//   }
+    APInt lb, ub;
+    if (BoundsJoin(S->getLB(), S->getUB(), T->getLB(), T->getUB(), lb, ub)){
+      setLB(lb);
+      setUB(ub);
+    }
+    else
+      makeTop();
+  }
 
   normalizeTop();
   // This is gross but we need to record that this is not bottom
@@ -628,17 +643,15 @@ void WrappedRange::WrappedJoin(AbstractValue *V){
 bool SortWrappedRanges_Compare(WrappedRange *R1, WrappedRange *R2){
   assert(R1);
   assert(R2);
-  APInt a = R1->getLB();
-  APInt c = R2->getLB();
-  return Lex_LessOrEqual(a,c); // a.ule(c);
+  return Lex_LessThan(R1->getLB(),R2->getLB()); // a.ult(c);
 }
 
 /// Sort a vector of wrapped ranges in order of lexicographical
 /// increasing left bound.
-void SortWrappedRanges(std::vector<WrappedRange *> & Rs){
+void SortWrappedRanges(SmallVectorImpl<WrappedRange *> & Rs){
 #ifdef DEBUG_GENERALIZED_JOIN
   dbgs() << "before sorted: \n";
-  for(std::vector<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
+  for(SmallVectorImpl<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
     WrappedRange *R = *I;
     R->printRange(dbgs());
   }
@@ -647,7 +660,7 @@ void SortWrappedRanges(std::vector<WrappedRange *> & Rs){
   std::sort(Rs.begin(), Rs.end() , SortWrappedRanges_Compare);
 #ifdef DEBUG_GENERALIZED_JOIN
   dbgs() << "after sorted: \n";
-  for(std::vector<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
+  for(SmallVectorImpl<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
     WrappedRange *R = *I;
     R->printRange(dbgs());
   }
@@ -655,14 +668,6 @@ void SortWrappedRanges(std::vector<WrappedRange *> & Rs){
 #endif 
 }
 
-// Wrapper for join
-WrappedRange Extend(const WrappedRange &R1, const  WrappedRange &R2){  
-  WrappedRange Res(R1);
-  WrappedRange tmp(R2);
-  Res.join(&tmp);
-  return Res;
-}
-
 /// Return the biggest of the two wrapped intervals.
 WrappedRange Bigger(const WrappedRange &R1, const WrappedRange &R2){
 
@@ -734,35 +739,48 @@ inline bool CrossNorthPole(const APInt &x,  const APInt &y)  {
 }
 
 
-inline WrappedRange * convertAbsValToWrapped(AbstractValue *V){
-  return cast<WrappedRange>(V);
+/// Store in LHS the generalized join of all the ranges in Rs. Rs is
+/// reordered.
+void GeneralizedJoinAll(WrappedRange *LHS, SmallVectorImpl<WrappedRange> &Rs){
+  SmallVector<WrappedRange*, 16> Ptrs;
+  for (unsigned i=0, e=Rs.size(); i < e; i++)
+    Ptrs.push_back(&Rs[i]);
+  LHS->GeneralizedJoin(Ptrs);
 }
 
 /// Algorithm Fig 3 from the paper. Finding the pseudo least upper
 /// bound of a set of wrapped ranges and assign it to this.
 void WrappedRange::
-GeneralizedJoin(std::vector<AbstractValue *> Values){
+GeneralizedJoin(const std::vector<AbstractValue *> &Values){
+  SmallVector<WrappedRange*, 8> Rs;
+  for (unsigned i=0, e=Values.size(); i < e; i++)
+    Rs.push_back(cast<WrappedRange>(Values[i]));
+  GeneralizedJoin(Rs);
+}
 
-  if (Values.size() < 2) return;
+/// Same as above but Rs is sorted in place. This is the version used
+/// by the transfer functions that join the partial results of the
+/// Cartesian product of the segments of their operands.
+void WrappedRange::GeneralizedJoin(SmallVectorImpl<WrappedRange *> &Rs){
 
-  std::vector<WrappedRange*> Rs;
-  std::transform(Values.begin(), Values.end(), 
-		 std::back_inserter(Rs), 
-		 convertAbsValToWrapped);
+  if (Rs.size() == 1){
+    WrappedRangeAssign(Rs[0]);
+    return;
+  }
 
   SortWrappedRanges(Rs);  
 
   WrappedRange f(*this);
   f.makeBot();
 
-  for(std::vector<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
-    WrappedRange R(*(*I));
-    if (R.IsTop() || CrossSouthPole(R.getLB(), R.getUB())){      
+  for(SmallVectorImpl<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
+    WrappedRange *R = *I;
+    if (R->IsTop() || CrossSouthPole(R->getLB(), R->getUB())){      
 #ifdef DEBUG_GENERALIZED_JOIN
-      dbgs() << R << " crosses the south pole!\n";
-      dbgs() << "extend(" << f << "," << R << ")=";
+      dbgs() << *R << " crosses the south pole!\n";
+      dbgs() << "extend(" << f << "," << *R << ")=";
 #endif 
-      f = Extend(f, R);
+      f.join(R);
 #ifdef DEBUG_GENERALIZED_JOIN
       dbgs() << f << "\n";
 #endif 
@@ -771,30 +789,43 @@ GeneralizedJoin(std::vector<AbstractValue *> Values){
 
   WrappedRange g(*this);
   g.makeBot();
-  for(std::vector<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
-    WrappedRange R(*(*I));
-    WrappedRange tmp = ClockWiseGap(f, R);
+  for(SmallVectorImpl<WrappedRange*>::iterator I=Rs.begin(), E=Rs.end() ; I!=E; ++I){
+    WrappedRange *R = *I;
+    WrappedRange tmp = ClockWiseGap(f, *R);
 #ifdef DEBUG_GENERALIZED_JOIN
-    dbgs() << "Gap(" << f << "," << R << " = " << tmp  << ")\n";
+    dbgs() << "Gap(" << f << "," << *R << " = " << tmp  << ")\n";
     dbgs() << "Bigger(" << g << "," << tmp  << ") = ";
 #endif 
     g = Bigger(g,tmp);
 #ifdef DEBUG_GENERALIZED_JOIN
     dbgs() << g << "\n";
-    dbgs() << "Extend(" << f << "," << R << ") = ";
+    dbgs() << "Extend(" << f << "," << *R << ") = ";
 #endif 
-    f = Extend(f, R);
+    f.join(R);
 #ifdef DEBUG_GENERALIZED_JOIN
     dbgs() << f << "\n";
 #endif 
   }
 
+  // All the ranges (if any) are bottom.
+  if (f.isBot()){
+    makeBot();
+    return;
+  }
+
   WrappedRange Tmp = WrappedComplement(Bigger(g,WrappedComplement(f)));
 #ifdef DEBUG_GENERALIZED_JOIN
   dbgs() << Tmp << "\n";
 #endif 
+  if (Tmp.IsTop()){
+    makeTop();
+    return;
+  }
+  makeBot();
   this->setLB(Tmp.getLB());
   this->setUB(Tmp.getUB());
+  resetBottomFlag();
+  normalizeTop();
 }
 
 // End  Machinery for generalized join
@@ -807,17 +838,17 @@ void WrappedRange::meet(AbstractValue *V1, AbstractValue *V2){
 #if 0
   this->makeBot();
   // **SOUTH POLE SPLIT** 
-  std::vector<WrappedRangePtr> s1 = 
-    WrappedRange::ssplit(R1->getLB(), R1->getUB(), R1->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    WrappedRange::ssplit(R2->getLB(), R2->getUB(), R2->getLB().getBitWidth());
+  WrappedRangeSplit s1;
+  WrappedRange::ssplit(R1->getLB(), R1->getUB(), R1->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  WrappedRange::ssplit(R2->getLB(), R2->getUB(), R2->getLB().getBitWidth(), s2);
 
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1=s1.begin(), E1=s1.end(); I1!=E1; ++I1){
     for (It I2=s2.begin(), E2=s2.end(); I2!=E2; ++I2){      
       // Note that we need to meet each pair of segments and then join
       // the result of all of them.
-      WrappedRange tmp = WrappedMeet((*I1).get(),(*I2).get());
+      WrappedRange tmp = WrappedMeet(&*I1,&*I2);
       this->WrappedJoin(&tmp);
     }
   }
@@ -979,20 +1010,20 @@ bool comparisonSignedLessThan(WrappedRange *I1,WrappedRange *I2, bool IsStrict){
 #endif /*DEBUG_EVALUATE_GUARD*/
   // **NORTH POLE SPLIT** and do normal test for all possible
   // pairs. If one is true then return true.
-  std::vector<WrappedRangePtr> s1 = 
-    WrappedRange::nsplit(I1->getLB(), I1->getUB(), 
-			 I1->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    WrappedRange::nsplit(I2->getLB(), I2->getUB(), 
-			 I2->getLB().getBitWidth());
+  WrappedRangeSplit s1;
+  WrappedRange::nsplit(I1->getLB(), I1->getUB(), 
+		       I1->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  WrappedRange::nsplit(I2->getLB(), I2->getUB(), 
+		       I2->getLB().getBitWidth(), s2);
   bool tmp=false;
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1=s1.begin(), E1=s1.end(); I1!=E1; ++I1){
     for (It I2=s2.begin(), E2=s2.end(); I2!=E2; ++I2){
       if (IsStrict)
-	tmp |= comparisonSlt_SameHemisphere((*I1).get(), (*I2).get());
+	tmp |= comparisonSlt_SameHemisphere(&*I1, &*I2);
       else
-	tmp |= comparisonSle_SameHemisphere((*I1).get(), (*I2).get());
+	tmp |= comparisonSle_SameHemisphere(&*I1, &*I2);
       if (tmp) {
 #ifdef DEBUG_EVALUATE_GUARD
 	dbgs() <<": true\n";
@@ -1019,21 +1050,21 @@ bool comparisonSignedLessThan(WrappedRange *I1,WrappedRange *I2, bool IsStrict){
 #endif /*DEBUG_EVALUATE_GUARD*/
   // **SOUTH POLE SPLIT** and do normal test for all possible
   // pairs. If one is true then return true.
-  std::vector<WrappedRangePtr> s1 = 
-    WrappedRange::ssplit(I1->getLB(), I1->getUB(), 
-			 I1->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    WrappedRange::ssplit(I2->getLB(), I2->getUB(), 
-			 I2->getLB().getBitWidth());
+  WrappedRangeSplit s1;
+  WrappedRange::ssplit(I1->getLB(), I1->getUB(), 
+		       I1->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  WrappedRange::ssplit(I2->getLB(), I2->getUB(), 
+		       I2->getLB().getBitWidth(), s2);
 
   bool tmp=false;
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1=s1.begin(), E1=s1.end(); I1!=E1; ++I1){
     for (It I2=s2.begin(), E2=s2.end(); I2!=E2; ++I2){
       if (IsStrict)
-	tmp |= comparisonUlt_SameHemisphere((*I1).get(), (*I2).get());
+	tmp |= comparisonUlt_SameHemisphere(&*I1, &*I2);
       else
-	tmp |= comparisonUle_SameHemisphere((*I1).get(), (*I2).get());
+	tmp |= comparisonUle_SameHemisphere(&*I1, &*I2);
       if (tmp){
 #ifdef DEBUG_EVALUATE_GUARD
 	dbgs() <<": true\n";
@@ -1078,76 +1109,75 @@ bool WrappedRange::comparisonUlt(AbstractValue *V){
 // Filter methods: they can refine an interval by using information
 // from other variables that appear in the guards.
 
-std::vector<std::pair<WrappedRangePtr,WrappedRangePtr> > 
-keepOnlyFeasibleRanges(unsigned Pred, 
-		       WrappedRange *V1, WrappedRange *V2){
-
-  std::vector<std::pair<WrappedRangePtr,WrappedRangePtr> > res;
-  std::vector<WrappedRangePtr> s1,s2;
+/// Split V1 and V2 at the poles (into s1 and s2) and add to res the
+/// pairs of segments for which Pred may hold. The pairs point to
+/// elements of s1 and s2.
+void keepOnlyFeasibleRanges(unsigned Pred, 
+			    WrappedRange *V1, WrappedRange *V2,
+			    WrappedRangeSplit &s1, WrappedRangeSplit &s2,
+			    WrappedRangePairs &res){
 
   if (BaseRange::IsSignedCompInst(Pred)){
     // **NORTH POLE SPLIT**
-    s1 = WrappedRange::nsplit(V1->getLB(), V1->getUB(), 
-			      V1->getLB().getBitWidth());
-    s2 = WrappedRange::nsplit(V2->getLB(), V2->getUB(), 
-			      V2->getLB().getBitWidth());
+    WrappedRange::nsplit(V1->getLB(), V1->getUB(), 
+			 V1->getLB().getBitWidth(), s1);
+    WrappedRange::nsplit(V2->getLB(), V2->getUB(), 
+			 V2->getLB().getBitWidth(), s2);
   }
   else{
     // **SOUTH POLE SPLIT**
-    s1 = WrappedRange::ssplit(V1->getLB(), V1->getUB(), 
-			      V1->getLB().getBitWidth());
-    s2 = WrappedRange::ssplit(V2->getLB(), V2->getUB(), 
-			      V2->getLB().getBitWidth());
+    WrappedRange::ssplit(V1->getLB(), V1->getUB(), 
+			 V1->getLB().getBitWidth(), s1);
+    WrappedRange::ssplit(V2->getLB(), V2->getUB(), 
+			 V2->getLB().getBitWidth(), s2);
   }
       
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1=s1.begin(), E1=s1.end(); I1!=E1; ++I1){
     for (It I2=s2.begin(), E2=s2.end(); I2!=E2; ++I2){
       switch(Pred){
       case ICmpInst::ICMP_EQ:
       case ICmpInst::ICMP_NE:
 	// FIMXE: no check??
-	res.push_back(std::make_pair((*I1), (*I2)));
+	res.push_back(std::make_pair(&*I1, &*I2));
         break;
       case ICmpInst::ICMP_SLE:
-	if (comparisonSignedLessThan((*I1).get(), (*I2).get(), false))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonSignedLessThan(&*I1, &*I2, false))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_SLT:
-	if (comparisonSignedLessThan((*I1).get(), (*I2).get(), true))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonSignedLessThan(&*I1, &*I2, true))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_ULE:
-	if (comparisonUnsignedLessThan((*I1).get(), (*I2).get(), false))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonUnsignedLessThan(&*I1, &*I2, false))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_ULT:
-	if (comparisonUnsignedLessThan((*I1).get(), (*I2).get(), true))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonUnsignedLessThan(&*I1, &*I2, true))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;	  
 	/////
       case ICmpInst::ICMP_SGT:
-	if (comparisonSignedLessThan((*I2).get(), (*I1).get(), true))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonSignedLessThan(&*I2, &*I1, true))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_SGE:
-	if (comparisonSignedLessThan((*I2).get(), (*I1).get(), false))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonSignedLessThan(&*I2, &*I1, false))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_UGT:
-	if (comparisonUnsignedLessThan((*I2).get(), (*I1).get(), true))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonUnsignedLessThan(&*I2, &*I1, true))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
       case ICmpInst::ICMP_UGE:
-	if (comparisonUnsignedLessThan((*I2).get(), (*I1).get(), false))
-	  res.push_back(std::make_pair((*I1), (*I2)));
+	if (comparisonUnsignedLessThan(&*I2, &*I1, false))
+	  res.push_back(std::make_pair(&*I1, &*I2));
 	break;
 
       } // end switch
     } // end inner for
   } //end outer for 
-
-  return res;
 }
 
 /// V1 is the range we would like to improve using information from
@@ -1167,16 +1197,16 @@ filterSigma(unsigned Pred, AbstractValue *V1, AbstractValue *V2){
   Var2->printRange(dbgs()); 
   dbgs() << "\n";      
 #endif /*DEBUG_FILTER_SIGMA*/
-  typedef std::pair<WrappedRangePtr,WrappedRangePtr> WrappedPtrPair; 
-  std::vector<WrappedPtrPair> s = keepOnlyFeasibleRanges(Pred,Var1,Var2);
+  WrappedRangeSplit s1, s2;
+  WrappedRangePairs s;
+  keepOnlyFeasibleRanges(Pred,Var1,Var2,s1,s2,s);
   // During narrowing (this) has a value from the fixpoint computation
   // which we want to (hopefully) improve. This is why we make this bottom. 
   this->makeBot();
 
-  for (std::vector<WrappedPtrPair>::iterator 
-	 I = s.begin(), E = s.end(); I!=E; ++I){
-    WrappedRange * WI1 = I->first.get();
-    WrappedRange * WI2 = I->second.get();
+  for (WrappedRangePairs::iterator I = s.begin(), E = s.end(); I!=E; ++I){
+    WrappedRange * WI1 = I->first;
+    WrappedRange * WI2 = I->second;
 #ifdef DEBUG_FILTER_SIGMA
     dbgs() << "\tAfter cutting the original intervals: "
            << " (" ;
@@ -1523,139 +1553,103 @@ bool IsWrappedOverflow_Shl(WrappedRange * Op, const APInt &shift){
 // Begin machinery for arithmetic and bitwise operations
 ////
 
-/// Cut only at north pole
-std::vector<WrappedRangePtr> 
-WrappedRange::nsplit(const APInt &x, const APInt &y, unsigned width){
+/// Cut only at north pole. The segments are appended to Res.
+void WrappedRange::nsplit(const APInt &x, const APInt &y, unsigned width,
+			  WrappedRangeSplit &Res){
 
-  // Temporary wrapped interval for north pole
+  // North pole
   APInt NP_lb = APInt::getSignedMaxValue(width); // 0111...1
   APInt NP_ub = APInt::getSignedMinValue(width); // 1000...0
-  WrappedRange NP(NP_lb,NP_ub,width);
-
-  // Temporary wrapped interval 
-  WrappedRangePtr s(new WrappedRange(x,y,width));
 
-  std::vector<WrappedRangePtr> res;
-  if (!(NP.WrappedlessOrEqual(s.get()))){
+  if (!CrossPole(NP_lb, NP_ub, x, y)){
     ////
     // No need of split
     ////
-    res.push_back(s);
-    return res;
+    Res.push_back(WrappedRange(x,y,width));
   }
   else{
     // Split into two wrapped intervals
-    WrappedRangePtr s1(new WrappedRange(x,NP_lb,width)); // [x,  0111...1]
-    WrappedRangePtr s2(new WrappedRange(NP_ub,y,width)); // [1000....0, y]
-    res.push_back(s1);
-    res.push_back(s2);
-    return res;  
+    Res.push_back(WrappedRange(x,NP_lb,width)); // [x,  0111...1]
+    Res.push_back(WrappedRange(NP_ub,y,width)); // [1000....0, y]
   }
 }
 
-/// Cut only at south pole
-std::vector<WrappedRangePtr> 
-WrappedRange::ssplit(const APInt &x, const APInt &y, unsigned width){
-  // Temporary wrapped interval for south pole
+/// Cut only at south pole. The segments are appended to Res.
+void WrappedRange::ssplit(const APInt &x, const APInt &y, unsigned width,
+			  WrappedRangeSplit &Res){
+  // South pole
   APInt SP_lb = APInt::getMaxValue(width); // 111...1
   APInt SP_ub(width, 0, false);
   //                    ^^^^^ unsigned
-  WrappedRange SP(SP_lb,SP_ub,width);
-  // Temporary wrapped interval 
-  WrappedRangePtr s(new WrappedRange(x,y,width));
 
-  std::vector<WrappedRangePtr> res;
-  if (!(SP.WrappedlessOrEqual(s.get()))){
+  if (!CrossPole(SP_lb, SP_ub, x, y)){
     ////
     // No need of split
     ////
-    res.push_back(s);
-    return res;
+    Res.push_back(WrappedRange(x,y,width));
   }
   else{
     // Split into two wrapped intervals
-    WrappedRangePtr s1(new WrappedRange(x,SP_lb,width)); // [x, 111....1]
-    WrappedRangePtr s2(new WrappedRange(SP_ub,y,width)); // [000...0,  y] 
-    res.push_back(s1);
-    res.push_back(s2);
-    return res;  
+    Res.push_back(WrappedRange(x,SP_lb,width)); // [x, 111....1]
+    Res.push_back(WrappedRange(SP_ub,y,width)); // [000...0,  y] 
   }
 }
 
-/// Cut both at north and south poles
-std::vector<WrappedRangePtr> psplit(const APInt &x, const APInt &y, unsigned width){
-
-  std::vector<WrappedRangePtr> res;  
-  std::vector<WrappedRangePtr> s1 = WrappedRange::nsplit(x,y,width);
-
-  for (std::vector<WrappedRangePtr>::iterator I = s1.begin(),
-	 E=s1.end() ; I!=E ; ++I){
-    WrappedRange *r = (*I).get();
-    std::vector<WrappedRangePtr> s2  = 
-      WrappedRange::ssplit(r->getLB(),r->getUB(),r->getLB().getBitWidth());
-    // append all elements of s2 into res
-    res.insert(res.end(),s2.begin(),s2.end());
-  }
-  return res;
+/// Cut both at north and south poles. The segments are appended to
+/// Res.
+void psplit(const APInt &x, const APInt &y, unsigned width, 
+	    WrappedRangeSplit &Res){
+  WrappedRangeSplit s1;
+  WrappedRange::nsplit(x,y,width,s1);
+  for (WrappedRangeSplit::iterator I = s1.begin(), E=s1.end() ; I!=E ; ++I)
+    WrappedRange::ssplit(I->getLB(),I->getUB(),I->getLB().getBitWidth(),Res);
 }
 
-std::vector<WrappedRangePtr>  purgeZero(WrappedRangePtr RPtr){
-  std::vector<WrappedRangePtr> purgedZeroIntervals; 
-  WrappedRange * R = RPtr.get();
+/// Append to Res the segments of R without zero.
+void purgeZero(WrappedRange &R, WrappedRangeSplit &Res){
 
-  assert(!(R->getLB() == 0  && R->getUB() == 0) && "Interval cannot be [0,0]");
+  assert(!(R.getLB() == 0  && R.getUB() == 0) && "Interval cannot be [0,0]");
 
-  unsigned width = R->getLB().getBitWidth();
+  unsigned width = R.getLB().getBitWidth();
   // Temporary wrapped interval for zero
   APInt Zero_lb(width, 0, false);          // 000...0 
   APInt Zero_ub(width, 0, false);          // 000...0 
   WrappedRange Zero(Zero_lb,Zero_ub,width);
 
-  if (Zero.lessOrEqual(R)){
-    if (R->getLB() == 0){
-      if (R->getUB() != 0){
+  if (Zero.lessOrEqual(&R)){
+    if (R.getLB() == 0){
+      if (R.getUB() != 0){
 	// Does not cross the south pole
-	WrappedRangePtr s(new WrappedRange(R->getLB()+1,R->getUB(),width)); 
-	purgedZeroIntervals.push_back(s);      
+	Res.push_back(WrappedRange(R.getLB()+1,R.getUB(),width)); 
       }
     }
     else{
-      if (R->getUB() == 0){
+      if (R.getUB() == 0){
 	// If interval is e.g., [1000,0000] then we keep one interval
 	APInt minusOne = APInt::getMaxValue(width); // 111...1
-	WrappedRangePtr s(new WrappedRange(R->getLB(),minusOne  ,width)); // [x, 111....1]
-	purgedZeroIntervals.push_back(s);
+	Res.push_back(WrappedRange(R.getLB(),minusOne  ,width)); // [x, 111....1]
       }
       else{
 	// Cross the south pole: split into two intervals
 	APInt plusOne(width, 1, false);              // 000...1 
 	APInt minusOne = APInt::getMaxValue(width); // 111...1
-	WrappedRangePtr s1(new WrappedRange(R->getLB(),minusOne  ,width)); // [x, 111....1]
-	WrappedRangePtr s2(new WrappedRange(plusOne   ,R->getUB(),width));  // [000...1,  y] 
-	purgedZeroIntervals.push_back(s1);
-	purgedZeroIntervals.push_back(s2);
+	Res.push_back(WrappedRange(R.getLB(),minusOne  ,width)); // [x, 111....1]
+	Res.push_back(WrappedRange(plusOne   ,R.getUB(),width));  // [000...1,  y] 
       }
     }
   }
   else{  
     // No need of split
-    WrappedRangePtr s(new WrappedRange(*R));
-    purgedZeroIntervals.push_back(s);
+    Res.push_back(R);
   }
-
-  return purgedZeroIntervals;
 }
 
-std::vector<WrappedRangePtr>  
-purgeZero(const std::vector<WrappedRangePtr> &Vs){
-  std::vector<WrappedRangePtr> res;
-  for (unsigned int i=0; i<Vs.size(); i++){
-    std::vector<WrappedRangePtr> purgedZeroIntervals = purgeZero(Vs[i]);
-    res.insert(res.end(), 
-	       purgedZeroIntervals.begin(), 
-	       purgedZeroIntervals.end());
-  }
-  return res;
+/// Remove zero from all the segments in Vs.
+void purgeZero(WrappedRangeSplit &Vs){
+  WrappedRangeSplit Res;
+  for (unsigned int i=0; i<Vs.size(); i++)
+    purgeZero(Vs[i], Res);
+  Vs.swap(Res);
 }
 ////
 // End machinery for arithmetic and bitwise operations
@@ -1770,34 +1764,33 @@ void WrappedRange::WrappedMultiplication(WrappedRange *LHS,
   // General case: south pole and north pole cuts, meet the signed and
   // unsigned operation for each element of the Cartesian product and
   // then lubbing them
-  std::vector<WrappedRangePtr> s1 = 
-    psplit(Op1->getLB(), Op1->getUB(), Op1->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    psplit(Op2->getLB(), Op2->getUB(), Op2->getLB().getBitWidth());
-
-  LHS->makeBot();  
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  WrappedRangeSplit s1;
+  psplit(Op1->getLB(), Op1->getUB(), Op1->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  psplit(Op2->getLB(), Op2->getUB(), Op2->getLB().getBitWidth(), s2);
+
+  // The partial results are joined all together at the end since
+  // GeneralizedJoin is more precise than joining them one by one.
+  SmallVector<WrappedRange, 16> Parts;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
     for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
-      WrappedRange Tmp1 = UnsignedWrappedMult((*I1).get(),(*I2).get());
-      WrappedRange Tmp2 = SignedWrappedMult((*I1).get(),(*I2).get());
+      WrappedRange Tmp1 = UnsignedWrappedMult(&*I1,&*I2);
+      WrappedRange Tmp2 = SignedWrappedMult(&*I1,&*I2);
 #ifdef DEBUG_MULT
-      dbgs() << "Op1=" << *((*I1).get()) << " Op2=" << *((*I2).get()) << "\n";
+      dbgs() << "Op1=" << *I1 << " Op2=" << *I2 << "\n";
       dbgs() << "Unsigned version    : " << Tmp1 << "\n";
       dbgs() << "Signed version      : " << Tmp2 << "\n";
 #endif 
-      WrappedRange tmp = WrappedMeet(&Tmp1,&Tmp2);
+      Parts.push_back(WrappedMeet(&Tmp1,&Tmp2));
 #ifdef DEBUG_MULT
-      dbgs() << "The best of the two : " << tmp << "\n";
-#endif 
-      // TODO: better call to GeneralizedJoin with all Tmps's
-      LHS->join(&tmp);
-#ifdef DEBUG_MULT
-      dbgs() << "Final multiplication so far : " << *LHS << "\n";
+      dbgs() << "The best of the two : " << Parts.back() << "\n";
 #endif 
     }
   }
+  GeneralizedJoinAll(LHS, Parts);
 #ifdef DEBUG_MULT
+  dbgs() << "Final multiplication : " << *LHS << "\n";
   dbgs() << "-----------------------------------\n";
 #endif 
 }
@@ -1916,20 +1909,21 @@ void WrappedRange::WrappedDivision(WrappedRange *LHS,
     // operation for each element of the Cartesian product and then
     // lubbing them. Note that we make sure that [0,0] is removed from
     // the divisor.
-    std::vector<WrappedRangePtr> s1 = 
-      psplit(Dividend->getLB(), Dividend->getUB(), 
-	     Dividend->getLB().getBitWidth());
-    std::vector<WrappedRangePtr> s2 = 
-      purgeZero(psplit(Divisor->getLB(), Divisor->getUB(), 
-		       Divisor->getLB().getBitWidth()));
+    WrappedRangeSplit s1;
+    psplit(Dividend->getLB(), Dividend->getUB(), 
+	   Dividend->getLB().getBitWidth(), s1);
+    WrappedRangeSplit s2;
+    psplit(Divisor->getLB(), Divisor->getUB(), 
+		     Divisor->getLB().getBitWidth(), s2);
+    purgeZero(s2);
     assert(!s2.empty() && "Sanity check: empty means interval [0,0]");
 
-    typedef std::vector<WrappedRangePtr>::iterator It;
+    typedef WrappedRangeSplit::iterator It;
     LHS->makeBot();  
     for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
       for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
    	bool IsOverflow;
-	WrappedRange Tmp = WrappedSignedDivision((*I1).get(),(*I2).get(),
+	WrappedRange Tmp = WrappedSignedDivision(&*I1,&*I2,
 						 IsOverflow);
   	if (IsOverflow){
   	  NumOfOverflows++;
@@ -1945,18 +1939,19 @@ void WrappedRange::WrappedDivision(WrappedRange *LHS,
     // each element of the Cartesian product and then lubbing
     // them. Note that we make sure that [0,0] is removed from the
     // divisor.
-    std::vector<WrappedRangePtr> s1 = 
-      ssplit(Dividend->getLB(), Dividend->getUB(), 
-	     Dividend->getLB().getBitWidth());
-    std::vector<WrappedRangePtr> s2 = 
-      purgeZero(ssplit(Divisor->getLB(), Divisor->getUB(), 
-		       Divisor->getLB().getBitWidth()));
+    WrappedRangeSplit s1;
+    ssplit(Dividend->getLB(), Dividend->getUB(), 
+	   Dividend->getLB().getBitWidth(), s1);
+    WrappedRangeSplit s2;
+    ssplit(Divisor->getLB(), Divisor->getUB(), 
+		     Divisor->getLB().getBitWidth(), s2);
+    purgeZero(s2);
     assert(!s2.empty() && "Sanity check: empty means interval [0,0]");
     LHS->makeBot();  
-    typedef std::vector<WrappedRangePtr>::iterator It;
+    typedef WrappedRangeSplit::iterator It;
     for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
       for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
-	WrappedRange Tmp = WrappedUnsignedDivision((*I1).get(),(*I2).get());
+	WrappedRange Tmp = WrappedUnsignedDivision(&*I1,&*I2);
 	LHS->join(&Tmp);
       }
     }
@@ -1984,22 +1979,24 @@ void WrappedRange::
     // each element of the Cartesian product and then lubbing
     // them. Note that we make sure that [0,0] is removed from the
     // divisor.
-    std::vector<WrappedRangePtr> s1 = 
-      ssplit(Dividend->getLB(), Dividend->getUB(), 
-	     Dividend->getLB().getBitWidth());
+    WrappedRangeSplit s1;
+    ssplit(Dividend->getLB(), Dividend->getUB(), 
+	   Dividend->getLB().getBitWidth(), s1);
+
+    WrappedRangeSplit s2;
+    ssplit(Divisor->getLB(), Divisor->getUB(), 
+		     Divisor->getLB().getBitWidth(), s2);
 
-    std::vector<WrappedRangePtr> s2 = 
-      purgeZero(ssplit(Divisor->getLB(), Divisor->getUB(), 
-		       Divisor->getLB().getBitWidth()));
+    purgeZero(s2);
     assert(!s2.empty() && "Sanity check: empty means interval [0,0]");
     LHS->makeBot();  
-    typedef std::vector<WrappedRangePtr>::iterator It;
+    typedef WrappedRangeSplit::iterator It;
     for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
       for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
-	APInt a = (*I1).get()->getLB();
-	APInt b = (*I1).get()->getUB();
-	APInt c = (*I2).get()->getLB();
-	APInt d = (*I2).get()->getUB();
+	APInt a = I1->getLB();
+	APInt b = I1->getUB();
+	APInt c = I2->getLB();
+	APInt d = I2->getUB();
 
 	bool IsZero_a = IsMSBZero(a);
 	bool IsZero_c = IsMSBZero(c);
@@ -2039,30 +2036,31 @@ void WrappedRange::
     // each element of the Cartesian product and then lubbing
     // them. Note that we make sure that [0,0] is removed from the
     // divisor.
-    std::vector<WrappedRangePtr> s1 = 
-      ssplit(Dividend->getLB(), Dividend->getUB(), 
-	     Dividend->getLB().getBitWidth());
-    std::vector<WrappedRangePtr> s2 = 
-      purgeZero(ssplit(Divisor->getLB(), Divisor->getUB(), 
-		       Divisor->getLB().getBitWidth()));
+    WrappedRangeSplit s1;
+    ssplit(Dividend->getLB(), Dividend->getUB(), 
+	   Dividend->getLB().getBitWidth(), s1);
+    WrappedRangeSplit s2;
+    ssplit(Divisor->getLB(), Divisor->getUB(), 
+		     Divisor->getLB().getBitWidth(), s2);
+    purgeZero(s2);
     assert(!s2.empty() && "Sanity check: empty means interval [0,0]");
     LHS->makeBot();  
-    typedef std::vector<WrappedRangePtr>::iterator It;
+    typedef WrappedRangeSplit::iterator It;
     for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
       for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
 	// This is a special case that can improve precision. It can
 	// be used also for the signed case. This is described in our
 	// journal version:
-	// WrappedRange Div = WrappedUnsignedDivision((*I1).get(),(*I2).get());
+	// WrappedRange Div = WrappedUnsignedDivision(&*I1,&*I2);
 	// if (WCard(Div.getLB(), Div.getUB()) == 1){
-	//   WrappedRange tmp1(*(*I2).get());
-	//   WrappedRange tmp2(*(*I2).get());
-	//   WrappedMinus(&tmp1,(*I1).get(),&Div);
-	//   WrappedMultiplication(&tmp2,&tmp1,(*I2).get());
+	//   WrappedRange tmp1(*I2);
+	//   WrappedRange tmp2(*I2);
+	//   WrappedMinus(&tmp1,&*I1,&Div);
+	//   WrappedMultiplication(&tmp2,&tmp1,&*I2);
 	//   LHS->join(&tmp2);
 	// }
 	// else{
-	APInt d  = (*I2).get()->getUB();
+	APInt d  = I2->getUB();
 	APInt lb = APInt(width, 0, false); 
 	APInt ub = d - 1;
  	unsigned width = d.getBitWidth();
@@ -2111,6 +2109,58 @@ void WrappedRange::
 }      
 
 
+/// Fill K with the opcode and the operands of a transfer function.
+/// Only native widths are cached.
+bool WrappedRange::makeCacheKey(TransferCache::Key &K, unsigned Opcode, 
+				const WrappedRange *Op1, const WrappedRange *Op2,
+				unsigned Width){
+  if (!WrappedBound::IsNative(Width) || 
+      !WrappedBound::IsNative(Op1->LB.getBitWidth()))
+    return false;
+  if (Op2 && !WrappedBound::IsNative(Op2->LB.getBitWidth()))
+    return false;
+
+  K.Opcode = Opcode;
+  K.Width  = Width;
+  K.Width1 = Op1->LB.getBitWidth();
+  K.Flags1 = (Op1->__isBottom ? TransferCache::IS_BOT : 0) | 
+             (Op1->__isTop    ? TransferCache::IS_TOP : 0);
+  K.LB1    = Op1->LB.getZExtValue();
+  K.UB1    = Op1->UB.getZExtValue();
+  if (Op2){
+    K.Width2 = Op2->LB.getBitWidth();
+    K.Flags2 = (Op2->__isBottom ? TransferCache::IS_BOT : 0) | 
+               (Op2->__isTop    ? TransferCache::IS_TOP : 0);
+    K.LB2    = Op2->LB.getZExtValue();
+    K.UB2    = Op2->UB.getZExtValue();
+  }
+  return true;
+}
+
+/// If the result of K is cached then store it in this and return
+/// true.
+bool WrappedRange::lookupCache(TransferCache &Cache, 
+			       const TransferCache::Key &K){
+  TransferCache::Result R;
+  if (!Cache.lookup(K, R)) return false;
+  width = K.Width;
+  LB = APInt(width, R.LB, isSigned);
+  UB = APInt(width, R.UB, isSigned);
+  __isBottom = (R.Flags & TransferCache::IS_BOT);
+  __isTop    = (R.Flags & TransferCache::IS_TOP);
+  return true;
+}
+
+void WrappedRange::insertCache(TransferCache &Cache, 
+			       const TransferCache::Key &K) const {
+  TransferCache::Result R;
+  R.LB = LB.getZExtValue();
+  R.UB = UB.getZExtValue();
+  R.Flags = (__isBottom ? TransferCache::IS_BOT : 0) | 
+            (__isTop    ? TransferCache::IS_TOP : 0);
+  Cache.insert(K, R);
+}
+
 /// Perform the transfer function for binary arithmetic operations.
 AbstractValue* WrappedRange::
 visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
@@ -2118,16 +2168,38 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
 
   // test_GeneralizedJoin();
   
-  WrappedRange *Op1 = cast<WrappedRange>(V1);
-  WrappedRange *Op2 = cast<WrappedRange>(V2);
   WrappedRange *LHS = new WrappedRange(*this);
-        
+  ArithBinaryOp(LHS, cast<WrappedRange>(V1), cast<WrappedRange>(V2),
+		OpCode, OpCodeName);
+  return LHS;
+}
+
+/// Same as visitArithBinaryOp but the result is stored in Res.
+bool WrappedRange::
+visitArithBinaryOpInPlace(AbstractValue *Res, 
+			  AbstractValue *V1,AbstractValue *V2,
+			  unsigned OpCode, const char *OpCodeName){
+  WrappedRange *LHS = cast<WrappedRange>(Res);
+  *LHS = *this;
+  ArithBinaryOp(LHS, cast<WrappedRange>(V1), cast<WrappedRange>(V2),
+		OpCode, OpCodeName);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute a binary arithmetic operation. LHS must be a copy of this.
+void WrappedRange::
+ArithBinaryOp(WrappedRange *LHS, WrappedRange *Op1, WrappedRange *Op2, 
+	      unsigned OpCode, const char *OpCodeName){
+
   DEBUG(dbgs() << "\t [RESULT] ");
   DEBUG(Op1->printRange(dbgs()));
   DEBUG(dbgs() << " " << OpCodeName << " ");
   DEBUG(Op2->printRange(dbgs()));
   DEBUG(dbgs() << " = ");
 
+  TransferCache *Cache = TransferCache::getCurrent();
+  TransferCache::Key K;
+
   /// First simple cases: bottom, top, etc
   if (Op1->isBot() || Op2->isBot()){
     LHS->makeBot();
@@ -2145,6 +2217,11 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
   // bottom flag will turn on again.
   LHS->resetBottomFlag();
 
+  if (Cache && !makeCacheKey(K, OpCode, Op1, Op2, LHS->width))
+    Cache = NULL;
+  if (Cache && LHS->lookupCache(*Cache, K))
+    goto END;
+
   switch (OpCode){
   case Instruction::Add:
     WrappedPlus(LHS,Op1,Op2);
@@ -2171,12 +2248,13 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
     dbgs() << OpCodeName << "\n";
     llvm_unreachable("Arithmetic operation not implemented");
   } // end switch
+  if (Cache) LHS->insertCache(*Cache, K);
 
  END:
   LHS->normalizeTop();
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");              
-  return LHS;
+
 }
 
 // Pre: Operand is not bottom
@@ -2212,7 +2290,26 @@ void Truncate(WrappedRange *&LHS, WrappedRange *Operand, unsigned k){
 /// Perform the transfer function for casting operations.
 AbstractValue* WrappedRange::
 visitCast(Instruction &I, 
-	  AbstractValue * V, TBool *TB, bool){
+	  AbstractValue * V, TBool *TB, bool IsSigned){
+  WrappedRange *LHS = new WrappedRange(*this);
+  Cast(LHS, I, V, TB, IsSigned);
+  return LHS;
+}
+
+/// Same as visitCast but the result is stored in Res.
+bool WrappedRange::
+visitCastInPlace(AbstractValue *Res, Instruction &I, 
+		 AbstractValue * V, TBool *TB, bool IsSigned){
+  WrappedRange *LHS = cast<WrappedRange>(Res);
+  *LHS = *this;
+  Cast(LHS, I, V, TB, IsSigned);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute a casting operation. LHS must be a copy of this.
+void WrappedRange::
+Cast(WrappedRange *LHS, Instruction &I, 
+     AbstractValue * V, TBool *TB, bool){
 
   // Very special case: convert TBool to WrappedRange
   WrappedRange *RHS = NULL;
@@ -2226,7 +2323,6 @@ visitCast(Instruction &I,
     RHS = cast<WrappedRange>(V);    
     assert(!TB && "ERROR: some inconsistency found in visitCast");
   }
-  WrappedRange *LHS = new WrappedRange(*this);
 
   // During narrowing values that were top may not be. We need to
   // reset the top flag by hand (gross!)
@@ -2246,6 +2342,14 @@ visitCast(Instruction &I,
   /// Start doing casting: change width
   LHS->setZeroAndChangeWidth(destWidth);          
 
+  // Casts from Boolean flags are not cached.
+  TransferCache *Cache = (V ? TransferCache::getCurrent() : NULL);
+  TransferCache::Key K;
+  if (Cache && !makeCacheKey(K, I.getOpcode(), RHS, NULL, destWidth))
+    Cache = NULL;
+  if (Cache && LHS->lookupCache(*Cache, K))
+    goto END;
+
   /// Simple cases first: bottom and top
   if (RHS->isBot())
     LHS->makeTop(); // be conservative
@@ -2266,14 +2370,13 @@ visitCast(Instruction &I,
 	Utilities::getIntegerWidth(I.getType(),k);
 	// **SOUTH POLE SPLIT** and compute signed extension for each of
 	// two elements and then lubbing them
-	std::vector<WrappedRangePtr> s = 
-	  ssplit(RHS->getLB(), RHS->getUB(), RHS->getLB().getBitWidth());
+	WrappedRangeSplit s;
+	ssplit(RHS->getLB(), RHS->getUB(), RHS->getLB().getBitWidth(), s);
 	WrappedRange Tmp(*LHS);
 	LHS->makeBot();  
-	for (std::vector<WrappedRangePtr>::iterator 
-	       I=s.begin(), E=s.end(); I!=E; ++I){
-	  APInt a = (*I).get()->getLB();
-	  APInt b = (*I).get()->getUB();
+	for (WrappedRangeSplit::iterator I=s.begin(), E=s.end(); I!=E; ++I){
+	  APInt a = I->getLB();
+	  APInt b = I->getUB();
 	  Tmp.setLB(a.zext(k));
 	  Tmp.setUB(b.zext(k));
 #ifdef  DEBUG_CAST
@@ -2291,14 +2394,14 @@ visitCast(Instruction &I,
 	Utilities::getIntegerWidth(I.getType(),k);
 	// **NORTH POLE SPLIT** and compute signed extension for each of
 	// the two elements and then lubbing them
-	std::vector<WrappedRangePtr> s = 
-	  nsplit(RHS->getLB(), RHS->getUB(), RHS->getLB().getBitWidth());
+	WrappedRangeSplit s;
+	nsplit(RHS->getLB(), RHS->getUB(), RHS->getLB().getBitWidth(), s);
 	WrappedRange Tmp(*LHS);
 	LHS->makeBot();  
-	typedef std::vector<WrappedRangePtr>::iterator It;
+	typedef WrappedRangeSplit::iterator It;
 	for (It I=s.begin(), E=s.end(); I!=E; ++I){
-	  APInt a = (*I).get()->getLB();
-	  APInt b = (*I).get()->getUB();
+	  APInt a = I->getLB();
+	  APInt b = I->getUB();
 	  Tmp.setLB(a.sext(k));
 	  Tmp.setUB(b.sext(k));    
 #ifdef  DEBUG_CAST
@@ -2313,13 +2416,14 @@ visitCast(Instruction &I,
     default:; // bitcast are non-op
     } // end switch
   }
-  
+  if (Cache) LHS->insertCache(*Cache, K);
+
+ END:
   if (!V) delete RHS;
    LHS->normalizeTop();    
   DEBUG(dbgs() << "\t[RESULT]");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");      
-  return LHS;
 }
 
 void WrappedRange::WrappedLogicalBitwise(WrappedRange *LHS, 
@@ -2329,63 +2433,58 @@ void WrappedRange::WrappedLogicalBitwise(WrappedRange *LHS,
   // General case: **SOUTH POLE SPLIT** and compute operation for each
   // of the elements and then lubbing them
 
-  std::vector<WrappedRangePtr> s1 = 
-    ssplit(Op1->getLB(), Op1->getUB(), Op1->getLB().getBitWidth());
-  std::vector<WrappedRangePtr> s2 = 
-    ssplit(Op2->getLB(), Op2->getUB(), Op2->getLB().getBitWidth());
+  WrappedRangeSplit s1;
+  ssplit(Op1->getLB(), Op1->getUB(), Op1->getLB().getBitWidth(), s1);
+  WrappedRangeSplit s2;
+  ssplit(Op2->getLB(), Op2->getUB(), Op2->getLB().getBitWidth(), s2);
 
-  LHS->makeBot(); 
-  typedef std::vector<WrappedRangePtr>::iterator It;
+  SmallVector<WrappedRange, 16> Parts;
+  typedef WrappedRangeSplit::iterator It;
   for (It I1 = s1.begin(), E1 =s1.end(); I1 != E1; ++I1){
     for (It I2 = s2.begin(), E2 =s2.end(); I2 != E2; ++I2){
       switch(Opcode){
       case Instruction::Or:
 	{
 	  APInt lb; APInt ub;
-	  unimelb::unsignedOr((*I1).get(), (*I2).get(), lb, ub);
+	  unimelb::unsignedOr(&*I1, &*I2, lb, ub);
 	  WrappedRange Tmp(lb, ub, Op1->getLB().getBitWidth());
 #ifdef DEBUG_LOGICALBIT
-	  dbgs() << "OR(" << *((*I1).get()) << "," <<  *((*I2).get()) << ") = "
+	  dbgs() << "OR(" << *I1 << "," <<  *I2 << ") = "
 		 << Tmp << "\n";
 #endif 
-	  // FIXME: we could use GeneralizedJoin to be more precise.
-	  LHS->join(&Tmp);
+	  Parts.push_back(Tmp);
 	}
 	break;
       case Instruction::And:
 	{
 	  APInt lb; APInt ub;
-	  unimelb::unsignedAnd((*I1).get(), (*I2).get(), lb, ub);
+	  unimelb::unsignedAnd(&*I1, &*I2, lb, ub);
 	  WrappedRange Tmp(lb, ub, Op1->getLB().getBitWidth());
 #ifdef DEBUG_LOGICALBIT
-	  dbgs() << "AND(" << *((*I1).get()) << "," <<  *((*I2).get()) << ") = "
+	  dbgs() << "AND(" << *I1 << "," <<  *I2 << ") = "
 		 << Tmp << "\n";
 #endif 
-	  // FIXME: we could use GeneralizedJoin to be more precise.
-	  LHS->join(&Tmp);
+	  Parts.push_back(Tmp);
 	}
 	break;
       case Instruction::Xor:
 	{
 	  APInt lb; APInt ub;
-	  unimelb::unsignedXor((*I1).get(),(*I2).get(), lb, ub);
+	  unimelb::unsignedXor(&*I1,&*I2, lb, ub);
 	  WrappedRange Tmp(lb,ub,Op1->getLB().getBitWidth());
 #ifdef DEBUG_LOGICALBIT
-	  dbgs() << "XOR(" << *((*I1).get()) << "," <<  *((*I2).get()) << ") = "
+	  dbgs() << "XOR(" << *I1 << "," <<  *I2 << ") = "
 		 << Tmp << "\n";
 #endif 
-	  // FIXME: we could use GeneralizedJoin to be more precise.
-	  LHS->join(&Tmp);
+	  Parts.push_back(Tmp);
 	}
 	break;
       default:
 	llvm_unreachable("Unexpected instruction");
       } // end switch
-#ifdef DEBUG_LOGICALBIT
-      dbgs() << "After intermediate join: " << *LHS << "\n";
-#endif 
     }
   }
+  GeneralizedJoinAll(LHS, Parts);
 #ifdef DEBUG_LOGICALBIT
     dbgs() << "After lubbing "; LHS->print(dbgs()); dbgs() << "\n";
 #endif 
@@ -2535,10 +2634,30 @@ visitBitwiseBinaryOp(AbstractValue * V1,
 		     AbstractValue * V2, 
 		     const Type * Op1Ty, const Type * Op2Ty, 
 		     unsigned OpCode   , const char * OpCodeName){
-  
-  WrappedRange *Op1 = cast<WrappedRange>(V1);
-  WrappedRange *Op2 = cast<WrappedRange>(V2);
   WrappedRange *LHS = new WrappedRange(*this);
+  BitwiseBinaryOp(LHS, cast<WrappedRange>(V1), cast<WrappedRange>(V2),
+		  Op1Ty, Op2Ty, OpCode, OpCodeName);
+  return LHS;
+}
+
+/// Same as visitBitwiseBinaryOp but the result is stored in Res.
+bool WrappedRange::
+visitBitwiseBinaryOpInPlace(AbstractValue *Res,
+			    AbstractValue * V1, AbstractValue * V2, 
+			    const Type * Op1Ty, const Type * Op2Ty, 
+			    unsigned OpCode   , const char * OpCodeName){
+  WrappedRange *LHS = cast<WrappedRange>(Res);
+  *LHS = *this;
+  BitwiseBinaryOp(LHS, cast<WrappedRange>(V1), cast<WrappedRange>(V2),
+		  Op1Ty, Op2Ty, OpCode, OpCodeName);
+  return !LHS->lessOrEqual(this);
+}
+
+/// Execute a bitwise operation. LHS must be a copy of this.
+void WrappedRange::
+BitwiseBinaryOp(WrappedRange *LHS, WrappedRange *Op1, WrappedRange *Op2,
+		const Type * Op1Ty, const Type * Op2Ty, 
+		unsigned OpCode   , const char * OpCodeName){
 
   // Be careful: top can be improved. Therefore, don't return directly
   // top if one of the operand is top
@@ -2551,6 +2670,13 @@ visitBitwiseBinaryOp(AbstractValue * V1,
   // flag will turn on again.
   LHS->resetBottomFlag();
 
+  TransferCache *Cache = TransferCache::getCurrent();
+  TransferCache::Key K;
+  if (Cache && !makeCacheKey(K, OpCode, Op1, Op2, LHS->width))
+    Cache = NULL;
+  if (Cache && LHS->lookupCache(*Cache, K))
+    goto END;
+
   switch(OpCode){
   case Instruction::And:
   case Instruction::Xor:
@@ -2636,11 +2762,12 @@ visitBitwiseBinaryOp(AbstractValue * V1,
     break;
   default:;
   } // end switch
+  if (Cache) LHS->insertCache(*Cache, K);
 
+ END:
   LHS->normalizeTop();    
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");        
-  return LHS;  
 }
 
 
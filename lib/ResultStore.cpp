@@ -0,0 +1,273 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  ResultStore.cpp
+///        Binary file with the results of the analysis.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Support/ResultStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace unimelb;
+using namespace unimelb::ResultStore;
+
+static const char Magic[8] = { 'W','R','A','P','R','E','S','\0' };
+static const uint32_t ByteOrder = 0x01020304;
+
+namespace {
+  /// Order functions or values by name.
+  template<typename T>
+  struct ByName{
+    const std::vector<T> &V;
+    ByName(const std::vector<T> &V): V(V){}
+    bool operator()(unsigned i, unsigned j) const {
+      return V[i].Name < V[j].Name;
+    }
+  };
+
+  /// Pool of strings of the file.
+  struct StringPool{
+    std::string Data;
+    StringRefTy add(const std::string &S){
+      StringRefTy R;
+      R.Offset = Data.size();
+      R.Size   = S.size();
+      Data += S;
+      return R;
+    }
+  };
+
+  template<typename T>
+  inline bool writeArray(FILE *Out, const std::vector<T> &V){
+    return V.empty() || fwrite(&V[0], sizeof(T), V.size(), Out) == V.size();
+  }
+}
+
+bool Writer::write(const std::string &File, std::string &Error){
+  std::vector<unsigned> FOrder;
+  for (unsigned i=0; i < Functions.size(); i++)
+    FOrder.push_back(i);
+  std::sort(FOrder.begin(), FOrder.end(),
+	    ByName<FunctionResults>(Functions));
+
+  StringPool Strings;
+  std::vector<Function> Fs;
+  std::vector<Value> Vs;
+  std::vector<Block> Bs;
+  for (unsigned i=0; i < FOrder.size(); i++){
+    const FunctionResults &R = Functions[FOrder[i]];
+    Function F;
+    F.Name       = Strings.add(R.Name);
+    F.FirstValue = Vs.size();
+    F.NumValues  = R.Values.size();
+    F.FirstBlock = Bs.size();
+    F.NumBlocks  = R.Blocks.size();
+    Fs.push_back(F);
+
+    std::vector<unsigned> VOrder;
+    for (unsigned j=0; j < R.Values.size(); j++)
+      VOrder.push_back(j);
+    std::sort(VOrder.begin(), VOrder.end(),
+	      ByName<FunctionResults::ValueTy>(R.Values));
+    for (unsigned j=0; j < VOrder.size(); j++){
+      const FunctionResults::ValueTy &RV = R.Values[VOrder[j]];
+      Value V;
+      V.Name    = Strings.add(RV.Name);
+      V.Block   = RV.Block;
+      V.Width   = RV.Width;
+      V.Flags   = RV.Flags;
+      V.Padding = 0;
+      V.LB      = RV.LB;
+      V.UB      = RV.UB;
+      Vs.push_back(V);
+    }
+    for (unsigned j=0; j < R.Blocks.size(); j++){
+      Block B;
+      B.Name        = Strings.add(R.Blocks[j].Name);
+      B.IsReachable = R.Blocks[j].IsReachable;
+      Bs.push_back(B);
+    }
+  }
+
+  Header H;
+  memset(&H, 0, sizeof(H));
+  memcpy(H.Magic, Magic, sizeof(Magic));
+  H.Version         = Version;
+  H.ByteOrder       = ByteOrder;
+  H.NumFunctions    = Fs.size();
+  H.NumValues       = Vs.size();
+  H.NumBlocks       = Bs.size();
+  H.StringsSize     = Strings.Data.size();
+  H.FunctionsOffset = sizeof(Header);
+  H.ValuesOffset    = H.FunctionsOffset + Fs.size() * sizeof(Function);
+  H.BlocksOffset    = H.ValuesOffset + Vs.size() * sizeof(Value);
+  H.StringsOffset   = H.BlocksOffset + Bs.size() * sizeof(Block);
+
+  // Write into a temporary file and rename it so that readers never
+  // map a partially written file.
+  std::string Tmp = File + ".tmp";
+  FILE *Out = fopen(Tmp.c_str(), "wb");
+  if (!Out){
+    Error = "cannot open " + Tmp;
+    return false;
+  }
+  bool OK = (fwrite(&H, sizeof(H), 1, Out) == 1 &&
+	     writeArray(Out, Fs) && writeArray(Out, Vs) && writeArray(Out, Bs) &&
+	     fwrite(Strings.Data.data(), 1, Strings.Data.size(), Out) ==
+	     Strings.Data.size());
+  OK = (fclose(Out) == 0) && OK;
+  if (!OK || rename(Tmp.c_str(), File.c_str()) != 0){
+    remove(Tmp.c_str());
+    Error = "cannot write " + File;
+    return false;
+  }
+  return true;
+}
+
+bool Reader::open(const std::string &File, std::string &Error){
+  close();
+  int FD = ::open(File.c_str(), O_RDONLY);
+  if (FD < 0){
+    Error = "cannot open " + File;
+    return false;
+  }
+  struct stat St;
+  if (fstat(FD, &St) != 0 || (size_t) St.st_size < sizeof(Header)){
+    ::close(FD);
+    Error = File + " is not a result store";
+    return false;
+  }
+  void *Ptr = mmap(NULL, St.st_size, PROT_READ, MAP_SHARED, FD, 0);
+  ::close(FD);
+  if (Ptr == MAP_FAILED){
+    Error = "cannot map " + File;
+    return false;
+  }
+  Base = static_cast<const char*>(Ptr);
+  Size = St.st_size;
+  Hdr  = reinterpret_cast<const Header*>(Base);
+
+  const char *Problem = NULL;
+  if (memcmp(Hdr->Magic, Magic, sizeof(Magic)) != 0)
+    Problem = " is not a result store";
+  else if (Hdr->ByteOrder != ByteOrder)
+    Problem = " was written with a different byte order";
+  else if (Hdr->Version != Version)
+    Problem = " was written by a different version";
+  else if (!fits(Hdr->FunctionsOffset, (uint64_t) Hdr->NumFunctions * sizeof(Function)) ||
+	   !fits(Hdr->ValuesOffset, (uint64_t) Hdr->NumValues * sizeof(Value)) ||
+	   !fits(Hdr->BlocksOffset, (uint64_t) Hdr->NumBlocks * sizeof(Block)) ||
+	   !fits(Hdr->StringsOffset, Hdr->StringsSize))
+    Problem = " is truncated";
+  else if (!checkFunctions())
+    Problem = " is corrupted";
+  if (Problem){
+    Error = File + Problem;
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool Reader::fits(uint64_t Offset, uint64_t Length) const {
+  return Offset <= Size && Length <= Size - Offset;
+}
+
+bool Reader::checkString(const StringRefTy &S) const {
+  return S.Offset <= Hdr->StringsSize && S.Size <= Hdr->StringsSize - S.Offset;
+}
+
+/// Return true if every function only refers to its own values and
+/// blocks and to strings in the pool, so that no accessor can read
+/// outside the mapped file.
+bool Reader::checkFunctions() const {
+  for (unsigned i=0; i < Hdr->NumFunctions; i++){
+    const Function &F = getFunction(i);
+    if (!checkString(F.Name) ||
+	F.FirstValue > Hdr->NumValues || F.NumValues > Hdr->NumValues - F.FirstValue ||
+	F.FirstBlock > Hdr->NumBlocks || F.NumBlocks > Hdr->NumBlocks - F.FirstBlock)
+      return false;
+    for (unsigned j=0; j < F.NumValues; j++){
+      const Value &V = getValue(F, j);
+      if (!checkString(V.Name) || V.Block >= F.NumBlocks)
+	return false;
+    }
+    for (unsigned j=0; j < F.NumBlocks; j++)
+      if (!checkString(getBlock(F, j).Name))
+	return false;
+  }
+  return true;
+}
+
+void Reader::close(){
+  if (Base)
+    munmap(const_cast<char*>(Base), Size);
+  Base = NULL;
+  Size = 0;
+  Hdr  = NULL;
+}
+
+int Reader::compare(const StringRefTy &S, const std::string &Name) const {
+  const char *P = Base + Hdr->StringsOffset + S.Offset;
+  size_t N = std::min((size_t) S.Size, Name.size());
+  int C = memcmp(P, Name.data(), N);
+  if (C != 0) return C;
+  if (S.Size == Name.size()) return 0;
+  return (S.Size < Name.size() ? -1 : 1);
+}
+
+const Function * Reader::lookupFunction(const std::string &Name) const {
+  // Binary search: functions are sorted by name.
+  unsigned Lo = 0, Hi = Hdr->NumFunctions;
+  while (Lo < Hi){
+    unsigned Mid = Lo + (Hi - Lo) / 2;
+    int C = compare(getFunctions()[Mid].Name, Name);
+    if (C == 0) return &getFunctions()[Mid];
+    if (C < 0) Lo = Mid + 1; else Hi = Mid;
+  }
+  return NULL;
+}
+
+const Value * Reader::lookupValue(const Function &F, const std::string &Name) const {
+  // Binary search: the values of a function are sorted by name.
+  unsigned Lo = 0, Hi = F.NumValues;
+  while (Lo < Hi){
+    unsigned Mid = Lo + (Hi - Lo) / 2;
+    int C = compare(getValue(F, Mid).Name, Name);
+    if (C == 0) return &getValue(F, Mid);
+    if (C < 0) Lo = Mid + 1; else Hi = Mid;
+  }
+  return NULL;
+}
+
+void Reader::getResults(const Function &F, FunctionResults &R) const {
+  R.Name = getString(F.Name);
+  R.Values.clear();
+  R.Blocks.clear();
+  for (unsigned i=0; i < F.NumValues; i++){
+    const Value &V = getValue(F, i);
+    FunctionResults::ValueTy RV;
+    RV.Name  = getString(V.Name);
+    RV.Block = V.Block;
+    RV.Width = V.Width;
+    RV.Flags = V.Flags;
+    RV.LB    = V.LB;
+    RV.UB    = V.UB;
+    R.Values.push_back(RV);
+  }
+  for (unsigned i=0; i < F.NumBlocks; i++){
+    const Block &B = getBlock(F, i);
+    FunctionResults::BlockTy RB;
+    RB.Name        = getString(B.Name);
+    RB.IsReachable = B.IsReachable;
+    R.Blocks.push_back(RB);
+  }
+}
@@ -0,0 +1,126 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  ResultsCache.cpp
+///        Results of the analysis of functions kept across runs.
+//////////////////////////////////////////////////////////////////////////////
+
+#define DEBUG_TYPE "RangeAnalysis"
+#include "Support/ResultsCache.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <fstream>
+
+using namespace llvm;
+using namespace unimelb;
+
+STATISTIC(NumOfCachedFuncs   ,"Number of functions whose results were cached");
+
+/// First line of the file. Bump the version if the format changes.
+static const char *Magic = "wrapped-intervals results cache 1";
+
+/// 64-bit FNV-1a. It only depends on the bytes so keys are the same
+/// across runs and hosts.
+static uint64_t hashBytes(uint64_t H, StringRef S){
+  for (unsigned i=0, e=S.size(); i < e; i++){
+    H ^= (unsigned char) S[i];
+    H *= 1099511628211ULL;
+  }
+  return H;
+}
+
+uint64_t ResultsCache::getKey(const Function *F, StringRef Options){
+  std::string IR;
+  raw_string_ostream OS(IR);
+  F->print(OS);
+  OS.flush();
+  std::string Version;
+  raw_string_ostream VS(Version);
+  VS << "version=" << AnalysisVersion << " ";
+  VS.flush();
+  uint64_t H = 14695981039346656037ULL;
+  H = hashBytes(H, Version);
+  H = hashBytes(H, Options);
+  H = hashBytes(H, StringRef("\0", 1));
+  return hashBytes(H, IR);
+}
+
+bool ResultsCache::load(const std::string &File, std::string &Error){
+  Entries.clear();
+  std::ifstream In(File.c_str(), std::ios::in | std::ios::binary);
+  if (!In) return true;
+
+  std::string Line;
+  if (!std::getline(In, Line)) return true; // empty file
+  if (Line != Magic){
+    Error = File + " is not a results cache";
+    return false;
+  }
+  // Each entry is "key name-size output-size\n" followed by the name
+  // and the output.
+  uint64_t K;
+  size_t NameSize, OutputSize;
+  while (In >> std::hex >> K >> std::dec >> NameSize >> OutputSize){
+    In.get(); // '\n'
+    Entry E;
+    E.Name.resize(NameSize);
+    E.Output.resize(OutputSize);
+    if (NameSize)   In.read(&E.Name[0], NameSize);
+    if (OutputSize) In.read(&E.Output[0], OutputSize);
+    if (!In){
+      Error = File + " is truncated";
+      Entries.clear();
+      return false;
+    }
+    E.Used = false;
+    Entries[K] = E;
+  }
+  if (!In.eof()){
+    Error = File + " is corrupted";
+    Entries.clear();
+    return false;
+  }
+  return true;
+}
+
+bool ResultsCache::save(const std::string &File, std::string &Error) const {
+  std::ofstream Out(File.c_str(),
+		    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!Out){
+    Error = "cannot open " + File;
+    return false;
+  }
+  Out << Magic << "\n";
+  for (std::map<uint64_t, Entry>::const_iterator I = Entries.begin(),
+	 E = Entries.end(); I != E; ++I){
+    if (!I->second.Used) continue;
+    Out << std::hex << I->first << std::dec << " "
+	<< I->second.Name.size() << " " << I->second.Output.size() << "\n";
+    Out.write(I->second.Name.data(), I->second.Name.size());
+    Out.write(I->second.Output.data(), I->second.Output.size());
+  }
+  if (!Out){
+    Error = "cannot write " + File;
+    return false;
+  }
+  return true;
+}
+
+bool ResultsCache::lookup(uint64_t K, StringRef Name, std::string &Output){
+  std::map<uint64_t, Entry>::iterator It = Entries.find(K);
+  if (It == Entries.end() || StringRef(It->second.Name) != Name) return false;
+  It->second.Used = true;
+  Output = It->second.Output;
+  NumOfCachedFuncs++;
+  return true;
+}
+
+void ResultsCache::insert(uint64_t K, StringRef Name, const std::string &Output){
+  Entry &E = Entries[K];
+  E.Name   = Name.str();
+  E.Output = Output;
+  E.Used   = true;
+}
@@ -0,0 +1,79 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  TraceLog.cpp
+///        Timeline of the analysis in the trace event format.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Support/TraceLog.h"
+#include "Support/Utils.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace unimelb;
+
+TraceLog::TraceLog(): Origin(now()){}
+
+TraceLog::~TraceLog(){
+  for (unsigned i=0; i < Buffers.size(); i++)
+    delete Buffers[i];
+}
+
+TraceLog::Buffer * TraceLog::getBuffer(unsigned Tid){
+  if (Tid >= Buffers.size())
+    Buffers.resize(Tid + 1, NULL);
+  if (!Buffers[Tid])
+    Buffers[Tid] = new Buffer(Tid);
+  return Buffers[Tid];
+}
+
+void TraceLog::setThreadName(unsigned Tid, StringRef Name){
+  getBuffer(Tid)->ThreadName = Name.str();
+}
+
+/// Times are written in microseconds as the format requires.
+bool TraceLog::write(const std::string &File, std::string &ErrorInfo) const {
+  raw_fd_ostream Out(File.c_str(), ErrorInfo);
+  if (!ErrorInfo.empty()) return false;
+
+  Out << "{\"traceEvents\": [\n";
+  Out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+      << "\"args\": {\"name\": \"range analysis\"}}";
+  for (unsigned i=0; i < Buffers.size(); i++){
+    const Buffer *B = Buffers[i];
+    if (!B) continue;
+    if (!B->ThreadName.empty()){
+      Out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+	  << "\"tid\": " << B->Tid << ", \"args\": {\"name\": ";
+      Utilities::writeJSONString(Out, B->ThreadName);
+      Out << "}}";
+    }
+    for (unsigned j=0; j < B->Events.size(); j++){
+      const Buffer::Event &E = B->Events[j];
+      Out << ",\n{\"name\": ";
+      // Counters are per process in the viewers: the thread is made
+      // part of the name so each thread gets its own track.
+      if (E.Phase == 'C' && !B->ThreadName.empty())
+	Utilities::writeJSONString(Out, E.Name + " (" + B->ThreadName + ")");
+      else
+	Utilities::writeJSONString(Out, E.Name);
+      Out << ", \"cat\": \"" << E.Category << "\", \"ph\": \"" << E.Phase
+	  << "\", \"pid\": 1, \"tid\": " << B->Tid
+	  << ", \"ts\": " << format("%.3f", (E.Time - Origin) * 1e6);
+      if (E.Phase == 'X')
+	Out << ", \"dur\": " << format("%.3f", E.Duration * 1e6);
+      if (E.NumArgs > 0){
+	Out << ", \"args\": {";
+	for (unsigned k=0; k < E.NumArgs; k++)
+	  Out << (k > 0 ? ", " : "") << "\"" << E.Keys[k] << "\": " << E.Values[k];
+	Out << "}";
+      }
+      Out << "}";
+    }
+  }
+  Out << "\n],\n\"displayTimeUnit\": \"ms\"}\n";
+  return true;
+}
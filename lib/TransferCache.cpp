@@ -0,0 +1,68 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  TransferCache.cpp
+///        Bounded cache of the results of transfer functions.
+//////////////////////////////////////////////////////////////////////////////
+
+#define DEBUG_TYPE "RangeAnalysis"
+#include "Support/TransferCache.h"
+#include "llvm/ADT/Statistic.h"
+
+using namespace llvm;
+using namespace unimelb;
+
+STATISTIC(NumOfCacheLookups  ,"Number of lookups in the transfer function cache");
+STATISTIC(NumOfCacheHits     ,"Number of hits in the transfer function cache");
+STATISTIC(NumOfCacheEvictions,"Number of entries replaced in the transfer function cache");
+
+__thread TransferCache * TransferCache::Current = NULL;
+
+void TransferCache::resize(unsigned NumEntries){
+  unsigned Size = 0;
+  if (NumEntries > 0){
+    Size = 1;
+    while (Size < NumEntries && Size < (1U << 31)) Size <<= 1;
+  }
+  Entries.clear();
+  Entries.resize(Size);
+  for (unsigned i=0; i < Size; i++)
+    Entries[i].Valid = false;
+}
+
+static inline uint64_t mix(uint64_t H, uint64_t V){
+  H ^= V + 0x9e3779b97f4a7c15ULL + (H << 6) + (H >> 2);
+  return H;
+}
+
+inline TransferCache::Entry & TransferCache::getEntry(const Key &K){
+  uint64_t H = K.Opcode;
+  H = mix(H, ((uint64_t) K.Width << 32) | K.Width1);
+  H = mix(H, ((uint64_t) K.Width2 << 32) | (K.Flags1 << 8) | K.Flags2);
+  H = mix(H, K.LB1);
+  H = mix(H, K.UB1);
+  H = mix(H, K.LB2);
+  H = mix(H, K.UB2);
+  // Entries.size() is a power of two.
+  return Entries[(H ^ (H >> 32)) & (Entries.size() - 1)];
+}
+
+bool TransferCache::lookup(const Key &K, Result &R){
+  NumOfCacheLookups++;
+  Entry &E = getEntry(K);
+  if (!E.Valid || !(E.K == K)) return false;
+  NumOfCacheHits++;
+  R = E.R;
+  return true;
+}
+
+void TransferCache::insert(const Key &K, const Result &R){
+  Entry &E = getEntry(K);
+  if (E.Valid && !(E.K == K))
+    NumOfCacheEvictions++;
+  E.K = K;
+  E.R = R;
+  E.Valid = true;
+}
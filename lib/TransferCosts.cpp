@@ -0,0 +1,98 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  TransferCosts.cpp
+///        Cost of the transfer functions by opcode and width.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Support/TransferCosts.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+
+using namespace llvm;
+using namespace unimelb;
+
+TransferCosts::TransferCosts(): Table(NumOperations * NumWidths, NULL){}
+
+TransferCosts::~TransferCosts(){
+  clear();
+}
+
+void TransferCosts::clear(){
+  for (unsigned i=0; i < Table.size(); i++){
+    delete Table[i];
+    Table[i] = NULL;
+  }
+}
+
+void TransferCosts::merge(const TransferCosts &Other){
+  for (unsigned i=0; i < Table.size(); i++){
+    const Histogram *O = Other.Table[i];
+    if (!O) continue;
+    if (!Table[i]) Table[i] = new Histogram();
+    Histogram *H = Table[i];
+    H->Calls      += O->Calls;
+    H->Changed    += O->Changed;
+    H->TotalNanos += O->TotalNanos;
+    for (unsigned b=0; b < NumBuckets; b++)
+      H->Counts[b] += O->Counts[b];
+  }
+}
+
+double TransferCosts::getBucketValue(unsigned B){
+  if (B < 16) return B;
+  unsigned Octave = 4 + (B - 16) / 4;
+  uint64_t Width  = 1ULL << (Octave - 2);
+  uint64_t Lo     = (4 + (B - 16) % 4) * Width;
+  return Lo + Width / 2.0;
+}
+
+double TransferCosts::getPercentile(const Histogram &H, double P){
+  uint64_t Target = (uint64_t) (P * H.Calls);
+  if (Target == 0) Target = 1;
+  uint64_t Seen = 0;
+  for (unsigned b=0; b < NumBuckets; b++){
+    Seen += H.Counts[b];
+    if (Seen >= Target) return getBucketValue(b);
+  }
+  return getBucketValue(NumBuckets - 1);
+}
+
+struct TransferCosts::MoreExpensive{
+  const std::vector<Histogram*> &Table;
+  MoreExpensive(const std::vector<Histogram*> &Table): Table(Table){}
+  bool operator()(unsigned i, unsigned j) const {
+    return Table[i]->TotalNanos > Table[j]->TotalNanos;
+  }
+};
+
+void TransferCosts::write(raw_ostream &Out) const {
+  static const char *WidthNames[NumWidths] =
+    { "-", "i1", "i8", "i16", "i32", "i64", "other" };
+
+  std::vector<unsigned> Used;
+  for (unsigned i=0; i < Table.size(); i++)
+    if (Table[i]) Used.push_back(i);
+  std::stable_sort(Used.begin(), Used.end(), MoreExpensive(Table));
+
+  Out << "operation,width,calls,total (s),mean (ns),p50 (ns),p90 (ns),"
+      << "p99 (ns),changed (%)\n";
+  for (unsigned k=0; k < Used.size(); k++){
+    const Histogram &H = *Table[Used[k]];
+    unsigned Op = Used[k] / NumWidths;
+    const char *OpName =
+      (Op == SIGMA ? "filterSigma" :
+       (Op == PHI_JOIN ? "GeneralizedJoin" : Instruction::getOpcodeName(Op)));
+    Out << OpName << "," << WidthNames[Used[k] % NumWidths] << ","
+	<< H.Calls << ","
+	<< format("%.6f", H.TotalNanos / 1e9) << ","
+	<< format("%.1f", (double) H.TotalNanos / H.Calls) << ","
+	<< format("%.1f", getPercentile(H, 0.50)) << ","
+	<< format("%.1f", getPercentile(H, 0.90)) << ","
+	<< format("%.1f", getPercentile(H, 0.99)) << ","
+	<< format("%.1f", 100.0 * H.Changed / H.Calls) << "\n";
+  }
+}
@@ -0,0 +1,144 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+
+//////////////////////////////////////////////////////////////////////////////
+/// \file  WeakTopologicalOrder.cpp
+///        Weak topological ordering of the CFG of a function.
+///
+/// This is the algorithm of Figure 4 in Bourdoncle's paper with the
+/// recursion replaced by a stack of frames. Partitions are built by
+/// prepending elements so we collect them in reverse order and
+/// flatten them at the end.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Support/WeakTopologicalOrder.h"
+
+using namespace llvm;
+using namespace unimelb;
+
+static const unsigned INFINITE_DFN = ~0U;
+
+void WeakTopologicalOrder::clear(){
+  Entries.clear();
+  Heads.clear();
+  DFN.clear();
+  Stack.clear();
+  Frames.clear();
+  Num = 0;
+}
+
+void WeakTopologicalOrder::build(Function *F){
+  clear();
+  std::vector<Sequence> Partition;
+  pushVisit(&F->getEntryBlock(), &Partition);
+  while (!Frames.empty()){
+    Frame &Top = Frames.back();
+    if (Top.Succ != Top.SuccEnd){
+      BasicBlock *W = *Top.Succ;
+      ++Top.Succ;
+      if (Top.IsComponent){
+	if (DFN[W] == 0)
+	  pushVisit(W, &Top.Body);
+      }
+      else{
+	unsigned Min = DFN[W];
+	if (Min == 0)
+	  pushVisit(W, Top.Partition);
+	else if (Min <= Top.Head){
+	  Top.Head = Min;
+	  Top.Loop = true;
+	}
+      }
+      continue;
+    }
+    // All the successors are done: return from visit or component.
+    if (Top.IsComponent)
+      finishComponent(Top);
+    else if (finishVisit(Top))
+      continue; // Top is now the component of its block.
+    unsigned Min = Top.Head;
+    Frames.pop_back();
+    if (!Frames.empty() && !Frames.back().IsComponent && 
+	Min <= Frames.back().Head){
+      Frames.back().Head = Min;
+      Frames.back().Loop = true;
+    }
+  }
+  append(Entries, Partition);
+  DFN.clear();
+}
+
+/// Append the elements of Partition (collected in reverse order) to S.
+void WeakTopologicalOrder::append(Sequence &S,
+				  const std::vector<Sequence> &Partition){
+  for (std::vector<Sequence>::const_reverse_iterator
+	 I = Partition.rbegin(), E = Partition.rend(); I != E; ++I)
+    S.insert(S.end(), I->begin(), I->end());
+}
+
+/// Start visit(V) whose elements go to Partition.
+void WeakTopologicalOrder::pushVisit(BasicBlock *V, 
+				     std::vector<Sequence> *Partition){
+  Stack.push_back(V);
+  DFN[V] = ++Num;
+  Frames.push_back(Frame(V, Partition));
+  Frames.back().Head = Num;
+}
+
+/// End of visit(V) once its successors have been visited. Return true
+/// if V is the head of a component, in which case F becomes the call
+/// to component(V).
+bool WeakTopologicalOrder::finishVisit(Frame &F){
+  BasicBlock *V = F.Block;
+  if (F.Head != DFN[V])
+    return false;
+  DFN[V] = INFINITE_DFN;
+  BasicBlock *E = Stack.back();
+  Stack.pop_back();
+  if (!F.Loop){
+    F.Partition->push_back(Sequence(1, Entry(V,0)));
+    return false;
+  }
+  while (E != V){
+    DFN[E] = 0;
+    E = Stack.back();
+    Stack.pop_back();
+  }
+  F.IsComponent = true;
+  F.Succ = succ_begin(V);
+  F.SuccEnd = succ_end(V);
+  return true;
+}
+
+/// End of component(V) once the successors of V have been visited.
+void WeakTopologicalOrder::finishComponent(Frame &F){
+  Sequence S;
+  S.push_back(Entry(F.Block,0));
+  append(S, F.Body);
+  S[0].Size = S.size();
+  F.Partition->push_back(S);
+  Heads.insert(F.Block);
+}
+
+void WeakTopologicalOrder::print(raw_ostream &Out) const{
+  // Stack of the positions where the open components end.
+  std::vector<unsigned> Ends;
+  for (unsigned i=0, e=Entries.size(); i < e; i++){
+    while (!Ends.empty() && Ends.back() == i){
+      Out << ")";
+      Ends.pop_back();
+    }
+    if (i > 0) Out << " ";
+    if (Entries[i].isHead()){
+      Out << "(";
+      Ends.push_back(i + Entries[i].Size);
+    }
+    Out << Entries[i].Block->getName();
+  }
+  while (!Ends.empty()){
+    Out << ")";
+    Ends.pop_back();
+  }
+  Out << "\n";
+}
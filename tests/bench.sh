@@ -0,0 +1,279 @@
+#!/bin/bash
+
+######################################################################
+# Script to measure the performance of the analyses on a bunch of
+# programs and compare it with a previous run.
+# Usage: ./bench.sh [options] [prog[.c|.bc] ...]
+#        ./bench.sh -compare baseline.json report.json
+######################################################################
+
+CMMD="../tools/run.sh"
+TEST_DIR="../tests"
+
+usage() {
+cat <<EOF
+
+Usage: $0 [options] [prog[.c|.bc] ...]
+       $0 -compare baseline.json report.json [-threshold p]
+
+Run each configured pass on each program (by default, all the programs
+in $TEST_DIR) and write a JSON report with the wall time and the peak
+resident set size of every run together with the number of analyzed
+instructions, widenings and narrowing passes.
+
+  options:
+    -pass "Pass [options]"     configuration to run, as given to tools/run.sh.
+                               Can be repeated (default: -range-analysis and
+                               -wrapped-range-analysis).
+    -runs n                    timed runs of each configuration (default = 5).
+                               A first untimed run compiles the program.
+    -o file                    write the report to file (default = bench.json).
+    -baseline file             compare the report with file (see -compare).
+    -threshold p               ignore differences smaller than p% (default = 5).
+    -compare base new          only compare two reports. A difference is a
+                               regression if the mean of new is more than p%
+                               above the mean of base and Welch's t-test says
+                               it is significant (one-sided, 95%). Counters
+                               are deterministic so any increase above p% is
+                               a regression. Exit status is 1 if there is any.
+
+EOF
+}
+
+######################################################################
+# Usage: compareReports baseline.json report.json threshold
+######################################################################
+# The reports are read with awk: each result is on its own line.
+######################################################################
+function compareReports {
+    awk -v threshold=$3 '
+    function getStr(line, key,   s){
+	if (!match(line, "\"" key "\": \"[^\"]*\"")) return "";
+	s = substr(line, RSTART, RLENGTH);
+	sub(/^[^:]*: "/, "", s); sub(/"$/, "", s);
+	return s;
+    }
+    function getList(line, key,   s){
+	if (!match(line, "\"" key "\": \\[[^]]*\\]")) return "";
+	s = substr(line, RSTART, RLENGTH);
+	sub(/^[^[]*\[/, "", s); sub(/\]$/, "", s); gsub(/ /, "", s);
+	return s;
+    }
+    function getNum(line, key,   s){
+	if (!match(line, "\"" key "\": [0-9]+")) return 0;
+	s = substr(line, RSTART, RLENGTH);
+	sub(/^[^:]*: /, "", s);
+	return s + 0;
+    }
+    # One-sided critical values of the t distribution (95%).
+    function tcrit(df){
+	if (df < 1) df = 1;
+	if (df > 30) return 1.645;
+	return T[int(df)];
+    }
+    # Return 1 if the sample New is significantly greater than Base.
+    function slower(Base, New,   nb, nn, b, n, i, mb, mn, vb, vn, se, t, df){
+	nb = split(Base, b, ","); nn = split(New, n, ",");
+	if (nb == 0 || nn == 0) return 0;
+	mb = 0; for (i=1; i <= nb; i++) mb += b[i]; mb /= nb;
+	mn = 0; for (i=1; i <= nn; i++) mn += n[i]; mn /= nn;
+	Mean["base"] = mb; Mean["new"] = mn;
+	if (mn <= mb * (1 + threshold / 100)) return 0;
+	vb = 0; for (i=1; i <= nb; i++) vb += (b[i] - mb)^2; vb = (nb > 1 ? vb / (nb - 1) : 0);
+	vn = 0; for (i=1; i <= nn; i++) vn += (n[i] - mn)^2; vn = (nn > 1 ? vn / (nn - 1) : 0);
+	se = vb / nb + vn / nn;
+	if (se == 0) return 1;
+	t  = (mn - mb) / sqrt(se);
+	df = 1;
+	if (nb > 1 && nn > 1)
+	    df = se^2 / ((vb / nb)^2 / (nb - 1) + (vn / nn)^2 / (nn - 1));
+	return (t > tcrit(df));
+    }
+    function report(what, key, b, n){
+	split(key, k, SUBSEP);
+	printf("REGRESSION %-10s %s %s: %s -> %s\n", what, k[1], k[2], b, n);
+	regressions++;
+    }
+    BEGIN {
+	Counters["insts"]; Counters["widenings"]; Counters["narrowings"];
+	split("6.314 2.920 2.353 2.132 2.015 1.943 1.895 1.860 1.833 1.812 " \
+	      "1.796 1.782 1.771 1.761 1.753 1.746 1.740 1.734 1.729 1.725 " \
+	      "1.721 1.717 1.714 1.711 1.708 1.706 1.703 1.701 1.699 1.697", T, " ");
+    }
+    FNR == 1 { NumFiles++; }
+    /"file":/ {
+	key = getStr($0, "file") SUBSEP getStr($0, "config");
+	if (NumFiles == 1){
+	    BaseSeen[key] = 1;
+	    BaseStatus[key] = getStr($0, "status");
+	    BaseWall[key] = getList($0, "wall_ms");
+	    BaseRss[key]  = getList($0, "rss_kb");
+	    for (c in Counters) Base[key, c] = getNum($0, c);
+	}
+	else {
+	    NewSeen[key] = 1;
+	    NewStatus[key] = getStr($0, "status");
+	    NewWall[key] = getList($0, "wall_ms");
+	    NewRss[key]  = getList($0, "rss_kb");
+	    for (c in Counters) New[key, c] = getNum($0, c);
+	    Order[++n] = key;
+	}
+	next;
+    }
+    END {
+	for (i=1; i <= n; i++){
+	    key = Order[i];
+	    if (!(key in BaseSeen)) continue;
+	    compared++;
+	    if (BaseStatus[key] == "ok" && NewStatus[key] != "ok"){
+		report("status", key, BaseStatus[key], NewStatus[key]);
+		continue;
+	    }
+	    if (slower(BaseWall[key], NewWall[key]))
+		report("time", key, sprintf("%.1fms", Mean["base"]),
+		       sprintf("%.1fms", Mean["new"]));
+	    if (slower(BaseRss[key], NewRss[key]))
+		report("memory", key, sprintf("%dKB", Mean["base"]),
+		       sprintf("%dKB", Mean["new"]));
+	    for (c in Counters){
+		if (New[key, c] > Base[key, c] * (1 + threshold / 100))
+		    report(c, key, Base[key, c], New[key, c]);
+	    }
+	}
+	print "Compared results      : " compared + 0;
+	print "Number of regressions : " regressions + 0;
+	exit (regressions > 0);
+    }' $1 $2
+}
+
+######################################################################
+# Usage: getStat log description
+######################################################################
+function getStat {
+    awk -v desc="$2" 'index($0, " - " desc) { s += $1 } END { print s + 0 }' $1
+}
+
+######################################################################
+# Usage: join list
+######################################################################
+function join {
+    echo "$*" | sed 's/ /, /g'
+}
+
+# Process args
+CONFIGS=()
+PROGS=()
+RUNS=5
+OUT="bench.json"
+BASELINE=""
+THRESHOLD=5
+COMPARE_ONLY=0
+while [ "$1" != "" ]; do
+    case "$1" in
+	-help)
+	    usage
+	    exit 2
+	    ;;
+	-pass)
+	    CONFIGS+=("$2")
+	    shift 2
+	    ;;
+	-runs)
+	    RUNS=$2
+	    shift 2
+	    ;;
+	-o)
+	    OUT=$2
+	    shift 2
+	    ;;
+	-baseline)
+	    BASELINE=$2
+	    shift 2
+	    ;;
+	-threshold)
+	    THRESHOLD=$2
+	    shift 2
+	    ;;
+	-compare)
+	    COMPARE_ONLY=1
+	    BASELINE=$2
+	    OUT=$3
+	    shift 3
+	    ;;
+	-*)
+	    echo -e "ERROR: option $1 not recognized.\nExecute $0 -help to see options.\n"
+	    exit 2
+	    ;;
+	*)
+	    PROGS+=("$1")
+	    shift
+	    ;;
+    esac
+done
+
+if [ $COMPARE_ONLY -eq 1 ]; then
+    compareReports $BASELINE $OUT $THRESHOLD
+    exit $?
+fi
+
+if [ ${#CONFIGS[@]} -eq 0 ]; then
+    CONFIGS=("-range-analysis" "-wrapped-range-analysis")
+fi
+if [ ${#PROGS[@]} -eq 0 ]; then
+    PROGS=($TEST_DIR/*.c)
+fi
+TIME=""
+if [ -x /usr/bin/time ]; then
+    TIME="/usr/bin/time"
+fi
+
+LOG=$TEST_DIR/bench.log
+RSS=$TEST_DIR/bench.rss
+
+echo "RUNNING BENCHMARKS ... "
+echo "{" > $OUT
+echo "\"runs\": $RUNS," >> $OUT
+echo "\"results\": [" >> $OUT
+sep=""
+for prog in "${PROGS[@]}"; do
+    for config in "${CONFIGS[@]}"; do
+	echo "Running `basename $prog` $config"
+	# The first run compiles the program and warms up the caches.
+	status="ok"
+	if ! $CMMD $prog $config -analysis-stats >& $LOG; then
+	    status="failed"
+	fi
+	bc=${prog%.c}.bc
+	walls=()
+	rsss=()
+	for (( i=0; i < $RUNS; i++ )); do
+	    [ "$status" == "ok" ] || break
+	    start=`date +%s%N`
+	    if [ "$TIME" != "" ]; then
+		$TIME -f "%M" -o $RSS $CMMD $bc $config -analysis-stats >& $LOG || status="failed"
+		rsss+=(`tail -1 $RSS`)
+	    else
+		$CMMD $bc $config -analysis-stats >& $LOG || status="failed"
+	    fi
+	    end=`date +%s%N`
+	    walls+=($(( (end - start) / 1000000 )))
+	done
+	if [ "$status" == "ok" ] && ! grep -q "Statistics Collected" $LOG; then
+	    status="failed"
+	fi
+	insts=`getStat $LOG "Number of analyzed instructions"`
+	widenings=`getStat $LOG "Number of widen instructions"`
+	narrowings=`getStat $LOG "Number of narrowing passes"`
+	echo "$sep{\"file\": \"`basename $prog`\", \"config\": \"$config\", \"status\": \"$status\", \"wall_ms\": [`join ${walls[@]}`], \"rss_kb\": [`join ${rsss[@]}`], \"insts\": $insts, \"widenings\": $widenings, \"narrowings\": $narrowings}" >> $OUT
+	sep=","
+    done
+done
+echo "]" >> $OUT
+echo "}" >> $OUT
+rm -f $LOG $RSS
+echo "DONE. Report written to $OUT"
+
+if [ "$BASELINE" != "" ]; then
+    compareReports $BASELINE $OUT $THRESHOLD
+    exit $?
+fi
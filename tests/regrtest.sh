@@ -43,6 +43,59 @@ function getAndCheckStats {
     fi
 }
 
+#######################################################################
+# Usage: checkInterval output lb ub
+#######################################################################
+# where output is a filename with the results printed by the analysis
+#       and lb and ub are the signed bounds that some value must have.
+#######################################################################
+function checkInterval {
+    file=$1
+    if grep "\[u:[0-9]*|s:$2,u:[0-9]*|s:$3\]" $file > /dev/null ; then
+	echo "test passed."
+ 	success=$[ $success + 1]	
+    else
+	echo "test failed: no interval [$2,$3] in $file."
+ 	fails=$[ $fails + 1]	
+    fi
+}
+
+#######################################################################
+# Usage: checkNoInterval output lb ub
+#######################################################################
+# The opposite of checkInterval: no value can have the signed bounds
+# lb and ub.
+#######################################################################
+function checkNoInterval {
+    file=$1
+    if grep "\[u:[0-9]*|s:$2,u:[0-9]*|s:$3\]" $file > /dev/null ; then
+	echo "test failed: unexpected interval [$2,$3] in $file."
+ 	fails=$[ $fails + 1]	
+    else
+	echo "test passed."
+ 	success=$[ $success + 1]	
+    fi
+}
+
+#######################################################################
+# Usage: compareOutputs output1 output2
+#######################################################################
+# where output1 and output2 are filenames with the results printed
+#       by two runs of the analysis that must be the same.
+#######################################################################
+function compareOutputs {
+    grep -e "^Block" -e "Analysis Results" $1 > $1.results
+    grep -e "^Block" -e "Analysis Results" $2 > $2.results
+    if [ -s $1.results ] && diff $1.results $2.results > /dev/null ; then
+	echo "test passed."
+ 	success=$[ $success + 1]	
+    else
+	echo "test failed: results in $1 and $2 differ."
+ 	fails=$[ $fails + 1]	
+    fi
+    rm -f $1.results $2.results
+}
+
 
 echo "RUNNING REGRESSION TESTS ... "
 
@@ -120,6 +173,33 @@ getAndCheckStats $TEST_DIR/log 2 0
 echo "Running t24.c"
 $CMMD $TEST_DIR/t24.c $PASS -widening 3 -narrowing 1 >& $TEST_DIR/log
 getAndCheckStats $TEST_DIR/log 0 0
+echo "Running t25.c"
+for pass in -range-analysis -wrapped-range-analysis; do
+    $CMMD $TEST_DIR/t25.c $pass -widening 3 -narrowing 1 >& $TEST_DIR/log
+    $CMMD $TEST_DIR/t25.c $pass -widening 3 -narrowing 1 -accelerate-ivs >& $TEST_DIR/log.ivs
+    compareOutputs $TEST_DIR/log $TEST_DIR/log.ivs
+    checkNoInterval $TEST_DIR/log.ivs 0 100
+done
+rm -f $TEST_DIR/log.ivs
+
+echo "Running t26.c"
+for pass in -range-analysis -wrapped-range-analysis; do
+    $CMMD $TEST_DIR/t26.c $pass -widening 3 -narrowing 1 >& $TEST_DIR/log
+    checkInterval $TEST_DIR/log 4294967296 8589934591
+    checkInterval $TEST_DIR/log 0 8589934591
+done
+echo "Running t27.c"
+$CMMD $TEST_DIR/t27.c -range-analysis -widening 3 -narrowing 1 >& $TEST_DIR/log
+checkNoInterval $TEST_DIR/log -2147483648 9223372036854775807
+echo "Running t28.c"
+$CMMD $TEST_DIR/t28.c -range-analysis -widening 3 -narrowing 1 -wto >& $TEST_DIR/log
+checkInterval $TEST_DIR/log 0 100
+checkInterval $TEST_DIR/log 1 100
+checkInterval $TEST_DIR/log 0 99
+$CMMD $TEST_DIR/t28.c -wrapped-range-analysis -widening 3 -narrowing 1 -wto >& $TEST_DIR/log
+checkInterval $TEST_DIR/log 0 100
+checkInterval $TEST_DIR/log 1 100
+checkInterval $TEST_DIR/log 0 99
 
 echo "Running t31.c"
 $CMMD $TEST_DIR/t31.c $PASS -widening 3 -narrowing 1 >& $TEST_DIR/log
@@ -165,6 +245,16 @@ echo "Running t62.c"
 $CMMD $TEST_DIR/t62.c $PASS -widening 3 -narrowing 1 >& $TEST_DIR/log
 getAndCheckStats $TEST_DIR/log 0 0
 
+echo "Running t7.c and fannkuch.c with -jobs 4"
+for prog in t7.c fannkuch.c; do
+    for pass in -range-analysis -wrapped-range-analysis; do
+	$CMMD $TEST_DIR/$prog $pass -widening 3 -narrowing 1 -jobs 1 >& $TEST_DIR/log
+	$CMMD $TEST_DIR/$prog $pass -widening 3 -narrowing 1 -jobs 4 >& $TEST_DIR/log.jobs
+	compareOutputs $TEST_DIR/log $TEST_DIR/log.jobs
+    done
+done
+rm -f $TEST_DIR/log.jobs
+
 echo "DONE. "
 
 echo "==============================================="
@@ -0,0 +1,15 @@
+// induction variable acceleration (-accelerate-ivs) when the loop
+// body also assigns i: i does not stay within [0,100] so the closed
+// form must not be used and i must be widened as usual.
+
+int main(int p){
+  int i = 0;
+  int x = 0;
+  while (i < 100){
+    if (p) 
+      i = i + 200;
+    i = i + 1;
+    x = i;
+  }
+  return x;
+}
@@ -0,0 +1,20 @@
+// bitwise or and xor of 64-bit intervals whose bounds differ above
+// bit 31
+
+#define INTERVAL(__p,__x,__a,__b) {if (__p) __x=__a; else __x=__b;}
+
+int main(int p){
+  long long x1, y1, z1;
+  long long x2, y2, z2, w2;
+
+  INTERVAL(p,x1,4294967295LL,4294967296LL); // x1=[2^32-1,2^32]
+  y1 = 4294967296LL;                        // y1=2^32
+  z1 = x1 | y1;  // z1=[2^32,2^33-1] since 2^32 | 2^32 = 2^32
+
+  INTERVAL(p,x2,0LL,4294967296LL);          // x2=[0,2^32]
+  INTERVAL(p,y2,0LL,4294967296LL);          // y2=[0,2^32]
+  z2 = x2 | y2;  // z2=[0,2^33-1] since 2^32 | 2^32-1 = 2^33-1
+  w2 = x2 ^ y2;  // w2=[0,2^33-1]
+  
+  return (int) (z1 + z2 + w2);
+}
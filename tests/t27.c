@@ -0,0 +1,11 @@
+// widening of a 64-bit variable below all the landmarks: the lower
+// bound of x must go to the minimum, not up to the smallest landmark
+// (-2^31).
+
+int main(int p){
+  long long x = p;   // x=[-2^31,2^31-1]
+  int i;
+  for (i=0; i < 10; i++)
+    x = x * 2;       // x must include values below -2^31
+  return (int) (x >> 32);
+}
@@ -0,0 +1,10 @@
+// counted loop analyzed with -wto: the component must be iterated
+// until a whole pass over the body changes nothing.
+
+int main(){
+  int i;
+  int x = 0;
+  for (i=0; i < 100; i++)
+    x = i;      // x=[0,99]
+  return x;     // i=[0,100] and i+1=[1,100]
+}
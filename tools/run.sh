@@ -41,6 +41,32 @@ Pass is the pass that we want to run:
     options:
       -widening n              n is the widening threshold (0: no widening)
       -narrowing n             n is the number of narrowing iterations (0: no narrowing)
+      -wto                     compute the fixpoint following a weak topological order 
+                               of the CFG rather than using a worklist.
+      -narrow-worklist         narrow only from the widened values, following def-use
+                               chains. -narrowing n bounds the narrowings of each value.
+      -accelerate-ivs          start induction variables i = phi [C,..],[i+K,..] guarded by
+                               a comparison with a constant from their closed form.
+      -loop-landmarks          widen with the constants of each loop rather than with
+                               all the constants of the function.
+      -jobs n                  analyze up to n functions in parallel (default = 1).
+      -cache n                 memoize up to n results of wrapped transfer functions
+                               (default = 0). Hit rates are reported by -stats.
+      -results-cache file      reuse the results of the functions that did not change
+                               since the last run that used file.
+      -result-store file       write the intervals and the reachable blocks of each 
+                               function to file (see include/Support/ResultStore.h).
+      -budget-time ms          after ms milliseconds on a function widen to top at its
+      -budget-visits n         widening points (after n executed instructions or n 
+      -budget-widenings n      widenings, respectively). 0: no limit.
+      -budget-report file      write the functions that exceeded their budget to file.
+      -profile-report file     write the time of each phase and the work done for
+                               each function to file.
+      -profile-format f        format of -profile-report: csv (default) or json.
+      -trace file              write a timeline of the transformations and of the
+                               phases of each function to file (chrome://tracing).
+      -transfer-costs file     write the number of visits, total time, percentiles
+                               and changes of each opcode and width to file.
       -alias                   by default, -no-aa which always return maybe. If enabled 
                                then -basic-aa and -globalsmodref-aa are run to be more 
                                precise with global variables.
@@ -58,10 +84,18 @@ Pass is the pass that we want to run:
       -insert-ioc-traps        Compile .c program with -fcatch-undefined-ansic-behavior
                                which generates IOC trap blocks.
                                Note: clang version must support -fcatch-undefined-ansic-behavior
+
+  -domain-bench                measure the lattice operations and transfer functions of
+                               both domains (prog is not analyzed but opt needs one).
+    options:
+      -bench-iters n           executions of each operation (default = 100000).
+      -bench-seed n            seed of the random intervals (default = 1).
+      -bench-output file       write the CSV results to file rather than to stderr.
                                  
   general options:
     -help                      print this message
     -stats                     print stats
+    -analysis-stats            print stats without running -aa-eval (used by tests/bench.sh)
     -time                      print LLVM time passes
     -dot-cfg                   print .dot file of the LLVM IR
     -debug                     print debugging messages
@@ -143,6 +177,10 @@ while [ "$3" != "" ]; do
 	    shift
 	    GENERAL_OPTS="$GENERAL_OPTS -aa-eval -stats "
 	    ;;
+	-analysis-stats)
+	    shift
+	    GENERAL_OPTS="$GENERAL_OPTS -stats "
+	    ;;
 	-dot-cfg)
 	    shift
 	    GENERAL_OPTS="$GENERAL_OPTS -dot-cfg "
@@ -171,6 +209,97 @@ while [ "$3" != "" ]; do
 	    MYPASS_OPTS="$MYPASS_OPTS -narrowing=$3"
 	    shift
 	    ;;
+	-jobs)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -jobs=$3"
+	    shift
+	    ;;
+	-cache)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -transfer-cache=$3"
+	    shift
+	    ;;
+	-results-cache)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -results-cache=$3"
+	    shift
+	    ;;
+	-result-store)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -result-store=$3"
+	    shift
+	    ;;
+	-budget-time)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -budget-time=$3"
+	    shift
+	    ;;
+	-budget-visits)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -budget-visits=$3"
+	    shift
+	    ;;
+	-budget-widenings)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -budget-widenings=$3"
+	    shift
+	    ;;
+	-budget-report)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -budget-report=$3"
+	    shift
+	    ;;
+	-profile-report)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -profile-report=$3"
+	    shift
+	    ;;
+	-profile-format)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -profile-format=$3"
+	    shift
+	    ;;
+	-trace)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -trace-events=$3"
+	    shift
+	    ;;
+	-transfer-costs)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -transfer-costs=$3"
+	    shift
+	    ;;
+	-wto)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -iteration-strategy=wto"
+	    ;;
+	-narrow-worklist)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -narrowing-strategy=worklist"
+	    ;;
+	-accelerate-ivs)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -accelerate-ivs"
+	    ;;
+	-loop-landmarks)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -loop-landmarks"
+	    ;;
+	-bench-iters)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -domain-bench-iters=$3"
+	    shift
+	    ;;
+	-bench-seed)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -domain-bench-seed=$3"
+	    shift
+	    ;;
+	-bench-output)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -domain-bench-output=$3"
+	    shift
+	    ;;
 	-enable-optimizations)
 	    shift
 	    MYPASS_OPTS="$MYPASS_OPTS -enable-optimizations"